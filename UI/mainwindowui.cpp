@@ -58,6 +58,8 @@ void MainWindowUI::setupUI()
     openStlButton = new Button("Open STL File", centralWidget);
     openVtkButton = new Button("Open VTK File", centralWidget);
     rangeSlider = new DensitySlider(centralWidget);
+    bandPreviewCheckBox = new QCheckBox("Band Preview", centralWidget);
+    bandPreviewCheckBox->setStyleSheet("QCheckBox { color: white; background: transparent; }");
     modeComboBox = new ModeComboBox(centralWidget);
     
     processButton = new Button("Process", centralWidget);
@@ -68,6 +70,7 @@ void MainWindowUI::setupUI()
     leftPaneLayout->addWidget(openStlButton);
     leftPaneLayout->addWidget(openVtkButton);
     leftPaneLayout->addWidget(rangeSlider);
+    leftPaneLayout->addWidget(bandPreviewCheckBox);
     leftPaneLayout->addWidget(modeComboBox);
     leftPaneLayout->addWidget(processButton);
     leftPaneLayout->addWidget(export3mfButton);
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QPushButton>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include "widgets/DensitySlider.h"
@@ -35,6 +36,7 @@ public:
     Button* getExport3mfButton() const { return export3mfButton; }
     ModeComboBox* getModeComboBox() const { return modeComboBox; }
     DensitySlider* getRangeSlider() const { return rangeSlider; }
+    QCheckBox* getBandPreviewCheckBox() const { return bandPreviewCheckBox; }
     MessageConsole* getMessageConsole() const { return messageConsole; }
     DisplayOptionsContainer* getDisplayOptionsContainer() const { return displayOptionsContainer; }
     
@@ -65,6 +67,7 @@ private:
     Button* export3mfButton;
     ModeComboBox* modeComboBox;
     DensitySlider* rangeSlider;
+    QCheckBox* bandPreviewCheckBox;
     MessageConsole* messageConsole;
     DisplayOptionsContainer* displayOptionsContainer;
 };
@@ -0,0 +1,285 @@
+#include "SyntheticGrid.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkFloatArray.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSTLWriter.h>
+#include <vtkTriangleFilter.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+constexpr double BEAM_LENGTH = 100.0;  // mm
+constexpr double BEAM_SECTION = 25.0;  // mm
+constexpr double MAX_STRESS = 1.0e8;   // Pa
+
+// 六面体の頂点 0〜7 のうち、対角線 0-6 を共有する6つの四面体
+// 隣接する六面体と面の分割が一致し、いずれも正の体積になる順序
+constexpr int HEX_TO_TETS[6][4] = {
+    {0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+    {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}
+};
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> SyntheticGrid::createHexGrid(vtkIdType cellCount)
+{
+    Options options;
+    options.cellCount = cellCount;
+    return create(options);
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> SyntheticGrid::create(const Options& options)
+{
+    const bool tetrahedra = options.elementType == ElementType::Tetrahedron;
+    const int cellsPerHex = tetrahedra ? 6 : 1;
+    const int pointsPerCell = tetrahedra ? 4 : 8;
+    const double hexCount = static_cast<double>(options.cellCount) / cellsPerHex;
+
+    const vtkIdType n = std::max<vtkIdType>(1, static_cast<vtkIdType>(std::llround(std::cbrt(hexCount / 4.0))));
+    const vtkIdType nx = 4 * n;
+    const vtkIdType ny = n;
+    const vtkIdType nz = n;
+    const vtkIdType px = nx + 1;
+    const vtkIdType py = ny + 1;
+    const vtkIdType pz = nz + 1;
+    const vtkIdType numPoints = px * py * pz;
+    const vtkIdType numCells = nx * ny * nz * cellsPerHex;
+    const double spacing = BEAM_LENGTH / nx;
+
+    // 座標と応力は配列へ直接書き込む（大規模メッシュで SetPoint / SetValue の呼び出しを避ける）
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToFloat();
+    points->SetNumberOfPoints(numPoints);
+    float* coords = vtkFloatArray::SafeDownCast(points->GetData())->GetPointer(0);
+    for (vtkIdType k = 0; k < pz; ++k) {
+        for (vtkIdType j = 0; j < py; ++j) {
+            for (vtkIdType i = 0; i < px; ++i) {
+                const vtkIdType id = i + px * (j + py * k);
+                coords[3 * id + 0] = static_cast<float>(i * spacing);
+                coords[3 * id + 1] = static_cast<float>(j * spacing);
+                coords[3 * id + 2] = static_cast<float>(k * spacing);
+            }
+        }
+    }
+
+    vtkSmartPointer<vtkFloatArray> stress = vtkSmartPointer<vtkFloatArray>::New();
+    stress->SetName(STRESS_LABEL);
+    stress->SetNumberOfComponents(1);
+    stress->SetNumberOfTuples(numPoints);
+    fillStress(stress->GetPointer(0), coords, numPoints, options);
+
+    vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(numCells + 1);
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(numCells * pointsPerCell);
+    vtkIdType* offsetValues = offsets->GetPointer(0);
+    vtkIdType* ids = connectivity->GetPointer(0);
+
+    const vtkIdType layer = px * py;
+    vtkIdType cellId = 0;
+    for (vtkIdType k = 0; k < nz; ++k) {
+        for (vtkIdType j = 0; j < ny; ++j) {
+            for (vtkIdType i = 0; i < nx; ++i) {
+                const vtkIdType base = i + px * (j + py * k);
+                const vtkIdType hex[8] = {
+                    base, base + 1, base + 1 + px, base + px,
+                    base + layer, base + layer + 1, base + layer + 1 + px, base + layer + px
+                };
+                if (tetrahedra) {
+                    for (const auto& tet : HEX_TO_TETS) {
+                        vtkIdType* cell = ids + 4 * cellId;
+                        for (int v = 0; v < 4; ++v) {
+                            cell[v] = hex[tet[v]];
+                        }
+                        offsetValues[cellId] = 4 * cellId;
+                        ++cellId;
+                    }
+                } else {
+                    std::copy(hex, hex + 8, ids + 8 * cellId);
+                    offsetValues[cellId] = 8 * cellId;
+                    ++cellId;
+                }
+            }
+        }
+    }
+    offsetValues[numCells] = pointsPerCell * numCells;
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->SetPoints(points);
+    grid->SetCells(tetrahedra ? VTK_TETRA : VTK_HEXAHEDRON, cells);
+    grid->GetPointData()->SetScalars(stress);
+    addExtraArrays(grid, options.extraArrayCount);
+    return grid;
+}
+
+void SyntheticGrid::fillStress(float* stressValues, const float* coords, vtkIdType numPoints, const Options& options)
+{
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // 応力集中の中心（梁の内部にランダムに配置）と影響半径
+    struct Hotspot { double x, y, z; };
+    std::vector<Hotspot> hotspots;
+    if (options.stressField == StressField::Hotspots) {
+        for (int i = 0; i < std::max(1, options.hotspotCount); ++i) {
+            hotspots.push_back({unit(random) * BEAM_LENGTH, unit(random) * BEAM_SECTION, unit(random) * BEAM_SECTION});
+        }
+    }
+    const double radius = BEAM_SECTION * 0.3;
+    const double inverseTwoRadiusSquared = 1.0 / (2.0 * radius * radius);
+
+    for (vtkIdType id = 0; id < numPoints; ++id) {
+        const double x = coords[3 * id + 0];
+        const double y = coords[3 * id + 1];
+        const double z = coords[3 * id + 2];
+        double value = 0.0;
+        switch (options.stressField) {
+        case StressField::Bending:
+            value = (1.0 - x / BEAM_LENGTH) * std::abs(z - BEAM_SECTION / 2.0) / (BEAM_SECTION / 2.0);
+            break;
+        case StressField::Gradient:
+            value = 1.0 - x / BEAM_LENGTH;
+            break;
+        case StressField::Hotspots:
+            // 低い基準値に各応力集中のガウス分布を重ねる
+            value = 0.05;
+            for (const auto& hotspot : hotspots) {
+                const double dx = x - hotspot.x;
+                const double dy = y - hotspot.y;
+                const double dz = z - hotspot.z;
+                value += std::exp(-(dx * dx + dy * dy + dz * dz) * inverseTwoRadiusSquared);
+            }
+            value = std::min(value, 1.0);
+            break;
+        case StressField::Noise:
+            value = unit(random);
+            break;
+        }
+        if (options.noise > 0.0) {
+            value += options.noise * (2.0 * unit(random) - 1.0);
+        }
+        stressValues[id] = static_cast<float>(MAX_STRESS * std::max(0.0, value));
+    }
+}
+
+void SyntheticGrid::addExtraArrays(vtkUnstructuredGrid* grid, int count)
+{
+    // 読み込み時に不要な配列を読み飛ばす処理の評価用（応力として検出されない名前にする）
+    const vtkIdType numPoints = grid->GetNumberOfPoints();
+    const vtkIdType numCells = grid->GetNumberOfCells();
+    for (int i = 0; i < count; ++i) {
+        vtkSmartPointer<vtkFloatArray> pointArray = vtkSmartPointer<vtkFloatArray>::New();
+        pointArray->SetName(("Extra Point Array " + std::to_string(i + 1)).c_str());
+        pointArray->SetNumberOfComponents(3);
+        pointArray->SetNumberOfTuples(numPoints);
+        float* pointValues = pointArray->GetPointer(0);
+        for (vtkIdType id = 0; id < numPoints * 3; ++id) {
+            pointValues[id] = static_cast<float>((id * (i + 7)) % 1009) * 1.0e-3f;
+        }
+        grid->GetPointData()->AddArray(pointArray);
+
+        vtkSmartPointer<vtkIntArray> cellArray = vtkSmartPointer<vtkIntArray>::New();
+        cellArray->SetName(("Extra Cell Array " + std::to_string(i + 1)).c_str());
+        cellArray->SetNumberOfComponents(1);
+        cellArray->SetNumberOfTuples(numCells);
+        int* cellValues = cellArray->GetPointer(0);
+        for (vtkIdType id = 0; id < numCells; ++id) {
+            cellValues[id] = static_cast<int>(id % 97);
+        }
+        grid->GetCellData()->AddArray(cellArray);
+    }
+}
+
+bool SyntheticGrid::writeVtu(vtkUnstructuredGrid* grid, const std::string& fileName,
+                             Encoding encoding, Compressor compressor)
+{
+    vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+    writer->SetFileName(fileName.c_str());
+    writer->SetInputData(grid);
+    switch (encoding) {
+    case Encoding::Ascii:
+        writer->SetDataModeToAscii();
+        break;
+    case Encoding::Binary:
+        writer->SetDataModeToBinary();
+        break;
+    case Encoding::Appended:
+        writer->SetDataModeToAppended();
+        writer->EncodeAppendedDataOff();
+        break;
+    }
+    switch (compressor) {
+    case Compressor::None:
+        writer->SetCompressorTypeToNone();
+        break;
+    case Compressor::ZLib:
+        writer->SetCompressorTypeToZLib();
+        break;
+    case Compressor::LZ4:
+        writer->SetCompressorTypeToLZ4();
+        break;
+    }
+    if (writer->Write() == 0) {
+        std::cerr << "Error: Failed to write VTU file: " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SyntheticGrid::writeSurfaceStl(vtkUnstructuredGrid* grid, const std::string& fileName)
+{
+    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
+    geometryFilter->SetInputData(grid);
+
+    vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+    triangleFilter->SetInputConnection(geometryFilter->GetOutputPort());
+
+    vtkSmartPointer<vtkSTLWriter> writer = vtkSmartPointer<vtkSTLWriter>::New();
+    writer->SetFileName(fileName.c_str());
+    writer->SetInputConnection(triangleFilter->GetOutputPort());
+    writer->SetFileTypeToBinary();
+    if (writer->Write() == 0) {
+        std::cerr << "Error: Failed to write STL file: " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+vtkIdType SyntheticGrid::parseCellCount(const std::string& text)
+{
+    std::string value = text;
+    double scale = 1.0;
+    if (!value.empty() && (value.back() == 'k' || value.back() == 'K')) {
+        scale = 1.0e3;
+        value.pop_back();
+    } else if (!value.empty() && (value.back() == 'm' || value.back() == 'M')) {
+        scale = 1.0e6;
+        value.pop_back();
+    }
+    size_t parsed = 0;
+    double number = 0.0;
+    try {
+        number = std::stod(value, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
+    }
+    if (parsed == 0 || parsed != value.size() || number <= 0.0) {
+        throw std::runtime_error("Invalid cell count: " + text);
+    }
+    return static_cast<vtkIdType>(number * scale);
+}
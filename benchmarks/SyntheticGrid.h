@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+#include <vtkUnstructuredGrid.h>
+
+// ベンチマーク・スケーリング試験用の合成メッシュを生成するクラス
+// 形状は片持ち梁を模した 4:1:1 の直方体（100 x 25 x 25 mm）
+class SyntheticGrid {
+public:
+    // 応力配列の名前（VtkProcessor::detectStressLabel が検出する名前）
+    static constexpr const char* STRESS_LABEL = "von Mises Stress";
+
+    enum class ElementType {
+        Hexahedron,
+        Tetrahedron   // 六面体1つを対角線を共有する6つの四面体に分割する
+    };
+
+    enum class StressField {
+        Bending,      // 固定端（x = 0）の上下面で最大、自由端で 0 になる曲げ応力
+        Gradient,     // x 方向に線形に減少する応力
+        Hotspots,     // ランダムな位置に応力集中がある分布
+        Noise         // 一様乱数
+    };
+
+    enum class Encoding {
+        Ascii,
+        Binary,       // インラインのbase64
+        Appended      // ファイル末尾にまとめた生データ
+    };
+
+    enum class Compressor {
+        None,
+        ZLib,
+        LZ4
+    };
+
+    struct Options {
+        vtkIdType cellCount = 1000000;
+        ElementType elementType = ElementType::Hexahedron;
+        StressField stressField = StressField::Bending;
+        int hotspotCount = 3;
+        double noise = 0.0;         // 最大応力に対する乱数の振幅（0〜1、どの分布にも加算する）
+        unsigned int seed = 1;
+        int extraArrayCount = 0;    // 応力以外に追加する点データ・セルデータ配列の数（それぞれ）
+    };
+
+    // 設定に従ってメッシュを生成する（セル数は cellCount に最も近い値になる）
+    static vtkSmartPointer<vtkUnstructuredGrid> create(const Options& options);
+
+    // 六面体・曲げ応力の既定設定で生成する
+    static vtkSmartPointer<vtkUnstructuredGrid> createHexGrid(vtkIdType cellCount);
+
+    // VTUとして書き出す（Ascii の場合 compressor は無視される）
+    static bool writeVtu(vtkUnstructuredGrid* grid, const std::string& fileName,
+                         Encoding encoding = Encoding::Appended, Compressor compressor = Compressor::ZLib);
+
+    // 外表面を三角形化してバイナリSTLとして書き出す
+    static bool writeSurfaceStl(vtkUnstructuredGrid* grid, const std::string& fileName);
+
+    // "100k", "1M", "50M" のようなセル数の指定を解釈する（不正な値の場合は std::runtime_error）
+    static vtkIdType parseCellCount(const std::string& text);
+
+private:
+    static void fillStress(float* stressValues, const float* coords, vtkIdType numPoints, const Options& options);
+    static void addExtraArrays(vtkUnstructuredGrid* grid, int count);
+};
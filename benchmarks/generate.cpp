@@ -0,0 +1,116 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "SyntheticGrid.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+// スケーリング試験用の合成VTU（応力結果）と、その外表面のSTLを生成する
+//
+// 例: strecs3d-generate --cells 10M --element tet --field hotspots --extra-arrays 4 -o large/part
+//     → large/part.vtu と large/part.stl を出力
+
+namespace {
+
+template <typename T>
+T parseChoice(const QString& value, const std::map<QString, T>& choices, const char* optionName)
+{
+    auto it = choices.find(value.toLower());
+    if (it == choices.end()) {
+        QStringList names;
+        for (const auto& choice : choices) names << choice.first;
+        throw std::runtime_error(std::string("Invalid --") + optionName + ": " + value.toStdString()
+                                 + " (expected " + names.join(", ").toStdString() + ")");
+    }
+    return it->second;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate a synthetic VTU stress result and its outer-surface STL.");
+    parser.addHelpOption();
+    QCommandLineOption cellsOption("cells", "Approximate number of cells, e.g. 100k, 1M, 50M.", "count", "1M");
+    QCommandLineOption elementOption("element", "Element type: hex or tet.", "type", "hex");
+    QCommandLineOption fieldOption("field", "Stress field: bending, gradient, hotspots or noise.", "shape", "bending");
+    QCommandLineOption hotspotsOption("hotspots", "Number of stress hotspots for --field hotspots.", "count", "3");
+    QCommandLineOption noiseOption("noise", "Random noise added to any field, relative to the maximum stress (0-1).", "ratio", "0");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    QCommandLineOption extraArraysOption("extra-arrays", "Number of extra point and cell arrays to add.", "count", "0");
+    QCommandLineOption encodingOption("encoding", "VTU encoding: ascii, binary or appended.", "encoding", "appended");
+    QCommandLineOption compressorOption("compressor", "VTU compressor: none, zlib or lz4.", "compressor", "zlib");
+    QCommandLineOption outputOption({"o", "output"}, "Output path without extension (.vtu and .stl are appended).", "path", "synthetic");
+    QCommandLineOption noStlOption("no-stl", "Do not write the outer-surface STL.");
+    for (const auto* option : {&cellsOption, &elementOption, &fieldOption, &hotspotsOption, &noiseOption, &seedOption,
+                               &extraArraysOption, &encodingOption, &compressorOption, &outputOption, &noStlOption}) {
+        parser.addOption(*option);
+    }
+    parser.process(app);
+
+    SyntheticGrid::Options options;
+    SyntheticGrid::Encoding encoding;
+    SyntheticGrid::Compressor compressor;
+    try {
+        options.cellCount = SyntheticGrid::parseCellCount(parser.value(cellsOption).trimmed().toStdString());
+        options.elementType = parseChoice<SyntheticGrid::ElementType>(parser.value(elementOption), {
+            {"hex", SyntheticGrid::ElementType::Hexahedron},
+            {"tet", SyntheticGrid::ElementType::Tetrahedron}}, "element");
+        options.stressField = parseChoice<SyntheticGrid::StressField>(parser.value(fieldOption), {
+            {"bending", SyntheticGrid::StressField::Bending},
+            {"gradient", SyntheticGrid::StressField::Gradient},
+            {"hotspots", SyntheticGrid::StressField::Hotspots},
+            {"noise", SyntheticGrid::StressField::Noise}}, "field");
+        options.hotspotCount = parser.value(hotspotsOption).toInt();
+        options.noise = parser.value(noiseOption).toDouble();
+        options.seed = parser.value(seedOption).toUInt();
+        options.extraArrayCount = parser.value(extraArraysOption).toInt();
+        encoding = parseChoice<SyntheticGrid::Encoding>(parser.value(encodingOption), {
+            {"ascii", SyntheticGrid::Encoding::Ascii},
+            {"binary", SyntheticGrid::Encoding::Binary},
+            {"appended", SyntheticGrid::Encoding::Appended}}, "encoding");
+        compressor = parseChoice<SyntheticGrid::Compressor>(parser.value(compressorOption), {
+            {"none", SyntheticGrid::Compressor::None},
+            {"zlib", SyntheticGrid::Compressor::ZLib},
+            {"lz4", SyntheticGrid::Compressor::LZ4}}, "compressor");
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+
+    const std::filesystem::path outputBase = parser.value(outputOption).toStdString();
+    if (outputBase.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outputBase.parent_path(), ec);
+    }
+    const std::string vtuFile = outputBase.string() + ".vtu";
+    const std::string stlFile = outputBase.string() + ".stl";
+
+    const auto start = std::chrono::steady_clock::now();
+    vtkSmartPointer<vtkUnstructuredGrid> grid = SyntheticGrid::create(options);
+    std::cout << "Generated " << grid->GetNumberOfCells() << " cells, " << grid->GetNumberOfPoints() << " points" << std::endl;
+
+    if (!SyntheticGrid::writeVtu(grid, vtuFile, encoding, compressor)) {
+        return 1;
+    }
+    std::cout << "Wrote " << vtuFile << " (" << std::filesystem::file_size(vtuFile) << " bytes)" << std::endl;
+
+    if (!parser.isSet(noStlOption)) {
+        if (!SyntheticGrid::writeSurfaceStl(grid, stlFile)) {
+            return 1;
+        }
+        std::cout << "Wrote " << stlFile << " (" << std::filesystem::file_size(stlFile) << " bytes)" << std::endl;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Done in " << seconds << " s" << std::endl;
+    return 0;
+}
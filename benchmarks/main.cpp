@@ -0,0 +1,477 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QtGlobal>
+
+#include "SyntheticGrid.h"
+#include "../core/processing/DatasetCache.h"
+#include "../core/processing/DividedMesh.h"
+#include "../core/processing/VtkProcessor.h"
+#include "../core/processing/VtuBinaryCache.h"
+#include "../core/processing/Workspace.h"
+#include "../core/processing/lib3mfProcessor.h"
+#include "../utils/parallelUtility.h"
+#include "../utils/profiler.h"
+
+#include <vtkVersion.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// 処理の各段階の所要時間・スループット・ピークメモリを計測し、JSONで出力するベンチマーク
+//
+// 同梱のサンプル（examples 以下の VTU と STL の組）と、指定したセル数で生成した合成メッシュの
+// それぞれについて、読み込み・分割・STL書き出し・3MF作成と保存（Cura / Bambu）を計測する
+
+namespace {
+
+// 1回の計測結果
+struct StageMeasurement {
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+    std::int64_t cells = 0;      // 処理したセル数（cells/s の算出に使用）
+    std::int64_t bytes = 0;      // 読み書きしたバイト数（MB/s の算出に使用）
+    std::int64_t triangles = 0;
+    std::uint64_t peakRssBytes = 0;       // 計測終了時点のプロセスのピークRSS
+    std::int64_t peakRssDeltaBytes = 0;   // 計測中に増加したピークRSS
+};
+
+struct StageResult {
+    std::string name;
+    std::vector<StageMeasurement> runs;
+};
+
+struct BenchCase {
+    std::string name;
+    std::string source;   // "example" または "synthetic"
+    std::string vtuFile;
+    std::string stlFile;
+    double generateSeconds = 0.0;
+};
+
+struct CaseResult {
+    BenchCase benchCase;
+    std::int64_t cells = 0;
+    std::int64_t vtuBytes = 0;
+    std::vector<StageResult> stages;
+    std::string error;
+};
+
+StageMeasurement measure(const std::function<void(StageMeasurement&)>& func)
+{
+    StageMeasurement measurement;
+    const std::uint64_t peakRssStart = Profiler::getPeakRssBytes();
+    const double cpuStart = Profiler::getProcessCpuTimeMs();
+    const auto wallStart = std::chrono::steady_clock::now();
+    func(measurement);
+    measurement.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    measurement.cpuMs = Profiler::getProcessCpuTimeMs() - cpuStart;
+    measurement.peakRssBytes = Profiler::getPeakRssBytes();
+    measurement.peakRssDeltaBytes = static_cast<std::int64_t>(measurement.peakRssBytes - peakRssStart);
+    return measurement;
+}
+
+void record(std::vector<StageResult>& stages, const std::string& name, const StageMeasurement& measurement)
+{
+    auto it = std::find_if(stages.begin(), stages.end(), [&](const StageResult& stage) { return stage.name == name; });
+    if (it == stages.end()) {
+        stages.push_back({name, {}});
+        it = stages.end() - 1;
+    }
+    it->runs.push_back(measurement);
+}
+
+std::int64_t fileSize(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : static_cast<std::int64_t>(size);
+}
+
+std::int64_t directorySize(const std::filesystem::path& path)
+{
+    std::int64_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+        if (entry.is_regular_file()) {
+            total += fileSize(entry.path());
+        }
+    }
+    return total;
+}
+
+// 分割メッシュと入力STLを3MFモデルへ追加する（ProcessPipeline::loadInputFiles と同じ構成）
+std::int64_t addMeshes(Lib3mfProcessor& processor, const std::vector<DividedMesh>& meshes, const std::string& stlFile)
+{
+    std::int64_t triangles = 0;
+    for (const auto& mesh : meshes) {
+        if (!mesh.polyData || mesh.polyData->GetNumberOfPolys() == 0) continue;
+        if (!processor.addMesh(mesh.polyData, mesh.name)) {
+            throw std::runtime_error("Failed to add divided mesh: " + mesh.name);
+        }
+        triangles += mesh.polyData->GetNumberOfPolys();
+    }
+    vtkSmartPointer<vtkPolyData> stlData = DatasetCache::instance().getPolyData(stlFile);
+    if (!stlData || !processor.addMesh(stlData, std::filesystem::path(stlFile).filename().string())) {
+        throw std::runtime_error("Failed to load STL file: " + stlFile);
+    }
+    return triangles + stlData->GetNumberOfPolys();
+}
+
+// VTUバイナリキャッシュ（.s3dvtu）の使用を切り替える（VtuBinaryCache は呼び出しごとに環境変数を参照する）
+void setVtuCacheEnabled(bool enabled)
+{
+    qputenv("STRECS3D_VTU_CACHE", enabled ? "on" : "off");
+}
+
+// 1ケース分を1回実行し、各段階の計測結果を stages に追加する
+// measureWarmLoad が true の場合、VTUバイナリキャッシュから読み込む場合の時間も別の段階として計測する
+void runOnce(const BenchCase& benchCase, CaseResult& result, bool measureWarmLoad)
+{
+    // 読み込みは毎回ファイルから行う（キャッシュ済みのデータを使わない）
+    // 2回目以降の実行がバイナリキャッシュを読むだけにならないよう、VTUの解析を計測する段階では無効にする
+    DatasetCache::instance().clear();
+    setVtuCacheEnabled(false);
+    std::shared_ptr<Workspace> workspace = Workspace::create(Workspace::Backend::Disk);
+
+    VtkProcessor vtkProcessor(benchCase.vtuFile);
+    vtkProcessor.setWorkspace(workspace.get());
+
+    record(result.stages, "LoadAndPrepareData", measure([&](StageMeasurement& m) {
+        if (!vtkProcessor.LoadAndPrepareData()) {
+            throw std::runtime_error("Failed to load VTU file: " + benchCase.vtuFile);
+        }
+        m.cells = vtkProcessor.getCellCount();
+        m.bytes = fileSize(benchCase.vtuFile);
+    }));
+    result.cells = vtkProcessor.getCellCount();
+    result.vtuBytes = fileSize(benchCase.vtuFile);
+
+    if (measureWarmLoad) {
+        // 1回目の読み込みでキャッシュを作成し、2回目の読み込みを計測する
+        setVtuCacheEnabled(true);
+        for (int pass = 0; pass < 2; ++pass) {
+            DatasetCache::instance().clear();
+            VtkProcessor warmProcessor(benchCase.vtuFile);
+            warmProcessor.setWorkspace(workspace.get());
+            const StageMeasurement measurement = measure([&](StageMeasurement& m) {
+                if (!warmProcessor.LoadAndPrepareData()) {
+                    throw std::runtime_error("Failed to load VTU file: " + benchCase.vtuFile);
+                }
+                m.cells = warmProcessor.getCellCount();
+                // キャッシュを作成しない入力（直接マップできるVTU）は元ファイルから読む
+                const std::int64_t cacheBytes = fileSize(VtuBinaryCache::getCachePath(benchCase.vtuFile));
+                m.bytes = cacheBytes > 0 ? cacheBytes : fileSize(benchCase.vtuFile);
+            });
+            if (pass == 1) {
+                record(result.stages, "LoadAndPrepareDataWarm", measurement);
+            }
+        }
+        setVtuCacheEnabled(false);
+    }
+
+    // GUIの既定と同じく、応力範囲を4等分した4バンドに分割する
+    const double minStress = vtkProcessor.getMinStress();
+    const double maxStress = vtkProcessor.getMaxStress();
+    std::vector<double> thresholds;
+    for (int i = 0; i <= 4; ++i) {
+        thresholds.push_back(minStress + (maxStress - minStress) * i / 4.0);
+    }
+    vtkProcessor.prepareStressValues(thresholds);
+    const std::vector<double> densities = {10.0, 20.0, 40.0, 80.0};
+    std::vector<StressDensityMapping> mappings;
+    for (size_t i = 0; i < densities.size(); ++i) {
+        mappings.push_back({thresholds[i], thresholds[i + 1], densities[i]});
+    }
+
+    std::vector<vtkSmartPointer<vtkPolyData>> meshes;
+    record(result.stages, "divideMesh", measure([&](StageMeasurement& m) {
+        vtkProcessor.clearBandCache();
+        meshes = vtkProcessor.divideMesh();
+        if (meshes.empty()) {
+            throw std::runtime_error("No meshes generated");
+        }
+        m.cells = result.cells;
+        for (const auto& mesh : meshes) {
+            m.triangles += mesh->GetNumberOfPolys();
+        }
+    }));
+    const std::vector<DividedMesh> dividedMeshes = vtkProcessor.createDividedMeshList(meshes);
+
+    record(result.stages, "saveDividedMeshes", measure([&](StageMeasurement& m) {
+        vtkProcessor.saveDividedMeshes(meshes);
+        m.bytes = directorySize(workspace->getSubDirPath("div"));
+    }));
+
+    Lib3mfProcessor curaProcessor;
+    record(result.stages, "3mfAssemblyCura", measure([&](StageMeasurement& m) {
+        m.triangles = addMeshes(curaProcessor, dividedMeshes, benchCase.stlFile);
+        if (!curaProcessor.setMetaData(maxStress, mappings) || !curaProcessor.assembleObjects()) {
+            throw std::runtime_error("Failed to assemble Cura 3MF");
+        }
+    }));
+
+    record(result.stages, "3mfSaveCura", measure([&](StageMeasurement& m) {
+        const std::filesystem::path outputPath = workspace->getFilePath("bench/cura.3mf");
+        if (!curaProcessor.save3mf(outputPath.string())) {
+            throw std::runtime_error("Failed to save Cura 3MF");
+        }
+        m.bytes = fileSize(outputPath);
+    }));
+
+    record(result.stages, "3mfBambu", measure([&](StageMeasurement& m) {
+        Lib3mfProcessor bambuProcessor;
+        m.triangles = addMeshes(bambuProcessor, dividedMeshes, benchCase.stlFile);
+        const std::filesystem::path outputPath = workspace->getFilePath("bench/bambu.3mf");
+        if (!bambuProcessor.setMetaDataBambu(maxStress, mappings) || !bambuProcessor.save3mf(outputPath.string())) {
+            throw std::runtime_error("Failed to write Bambu 3MF");
+        }
+        m.bytes = fileSize(outputPath);
+    }));
+}
+
+std::vector<BenchCase> findExampleCases(const std::filesystem::path& examplesDir)
+{
+    std::vector<BenchCase> cases;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(examplesDir, ec)) {
+        if (!entry.is_directory()) continue;
+        BenchCase benchCase;
+        benchCase.name = entry.path().filename().string();
+        benchCase.source = "example";
+        for (const auto& file : std::filesystem::directory_iterator(entry.path(), ec)) {
+            const std::string extension = file.path().extension().string();
+            if (extension == ".vtu") benchCase.vtuFile = file.path().string();
+            if (extension == ".stl") benchCase.stlFile = file.path().string();
+        }
+        // 応力結果（VTU）のないサンプルは対象外
+        if (!benchCase.vtuFile.empty() && !benchCase.stlFile.empty()) {
+            cases.push_back(benchCase);
+        }
+    }
+    std::sort(cases.begin(), cases.end(), [](const BenchCase& a, const BenchCase& b) { return a.name < b.name; });
+    return cases;
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+QJsonObject stageToJson(const StageResult& stage)
+{
+    std::vector<double> wall;
+    std::vector<double> cpu;
+    std::uint64_t peakRss = 0;
+    std::int64_t peakRssDelta = 0;
+    for (const auto& run : stage.runs) {
+        wall.push_back(run.wallMs);
+        cpu.push_back(run.cpuMs);
+        peakRss = std::max(peakRss, run.peakRssBytes);
+        peakRssDelta = std::max(peakRssDelta, run.peakRssDeltaBytes);
+    }
+    const StageMeasurement& last = stage.runs.back();
+    const double wallMedian = median(wall);
+    const double seconds = wallMedian / 1000.0;
+
+    QJsonObject object;
+    object["name"] = QString::fromStdString(stage.name);
+    object["runs"] = static_cast<int>(stage.runs.size());
+    object["wallMsMedian"] = wallMedian;
+    object["wallMsMin"] = *std::min_element(wall.begin(), wall.end());
+    object["cpuMsMedian"] = median(cpu);
+    object["cells"] = static_cast<double>(last.cells);
+    object["bytes"] = static_cast<double>(last.bytes);
+    object["triangles"] = static_cast<double>(last.triangles);
+    object["cellsPerSecond"] = (seconds > 0.0 && last.cells > 0) ? last.cells / seconds : 0.0;
+    object["megabytesPerSecond"] = (seconds > 0.0 && last.bytes > 0) ? last.bytes / 1.0e6 / seconds : 0.0;
+    object["peakRssBytes"] = static_cast<double>(peakRss);
+    object["peakRssDeltaBytes"] = static_cast<double>(peakRssDelta);
+    return object;
+}
+
+QJsonObject caseToJson(const CaseResult& result)
+{
+    QJsonObject object;
+    object["name"] = QString::fromStdString(result.benchCase.name);
+    object["source"] = QString::fromStdString(result.benchCase.source);
+    object["vtuFile"] = QString::fromStdString(result.benchCase.vtuFile);
+    object["cells"] = static_cast<double>(result.cells);
+    object["vtuBytes"] = static_cast<double>(result.vtuBytes);
+    if (result.benchCase.source == "synthetic") {
+        object["generateSeconds"] = result.benchCase.generateSeconds;
+    }
+    if (!result.error.empty()) {
+        object["error"] = QString::fromStdString(result.error);
+    }
+    QJsonArray stages;
+    for (const auto& stage : result.stages) {
+        stages.append(stageToJson(stage));
+    }
+    object["stages"] = stages;
+    return object;
+}
+
+QJsonObject environmentToJson()
+{
+    QJsonObject object;
+    object["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    object["os"] = QSysInfo::prettyProductName();
+    object["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    object["hardwareThreads"] = static_cast<int>(std::thread::hardware_concurrency());
+    object["workerThreads"] = static_cast<int>(ParallelUtility::getWorkerCount());
+    object["vtkVersion"] = QString::fromLatin1(vtkVersion::GetVTKVersion());
+    object["qtVersion"] = QString::fromLatin1(qVersion());
+    return object;
+}
+
+void printCase(const CaseResult& result)
+{
+    std::cout << "\n== " << result.benchCase.name << " (" << result.cells << " cells, "
+              << std::fixed << std::setprecision(1) << result.vtuBytes / 1.0e6 << " MB) ==" << std::endl;
+    if (!result.error.empty()) {
+        std::cout << "  FAILED: " << result.error << std::endl;
+    }
+    for (const auto& stage : result.stages) {
+        const QJsonObject json = stageToJson(stage);
+        std::cout << "  " << std::left << std::setw(20) << stage.name << std::right
+                  << std::setw(10) << std::setprecision(1) << json["wallMsMedian"].toDouble() << " ms"
+                  << std::setw(14) << std::setprecision(0) << json["cellsPerSecond"].toDouble() << " cells/s"
+                  << std::setw(10) << std::setprecision(1) << json["megabytesPerSecond"].toDouble() << " MB/s"
+                  << std::setw(10) << std::setprecision(0) << json["peakRssBytes"].toDouble() / 1.0e6 << " MB peak"
+                  << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("Strecs3D");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the Strecs3D processing stages on the bundled examples and synthetic meshes.");
+    parser.addHelpOption();
+    QCommandLineOption examplesOption("examples", "Directory containing example VTU/STL pairs.", "dir", "examples");
+    QCommandLineOption sizesOption("sizes",
+        "Comma-separated synthetic cell counts, e.g. 100k,1M,10M,50M (empty to skip).", "list", "100k,1M,10M");
+    QCommandLineOption repeatOption("repeat", "Number of runs per case (median is reported).", "count", "3");
+    QCommandLineOption threadsOption("threads", "Worker threads used by parallel stages (0 = hardware threads).", "count", "0");
+    QCommandLineOption outputOption({"o", "output"}, "JSON result file.", "file", "strecs3d-bench.json");
+    parser.addOption(examplesOption);
+    parser.addOption(sizesOption);
+    parser.addOption(repeatOption);
+    parser.addOption(threadsOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    ParallelUtility::setWorkerCount(parser.value(threadsOption).toUInt());
+    const int repeat = std::max(1, parser.value(repeatOption).toInt());
+    // ベンチマーク中のスコープ計測の記録は不要
+    Profiler::setEnabled(false);
+    // 環境変数でバイナリキャッシュが無効にされている場合は、キャッシュからの読み込みを計測しない
+    const bool measureWarmLoad = VtuBinaryCache::isEnabled();
+
+    std::vector<BenchCase> cases = findExampleCases(parser.value(examplesOption).toStdString());
+    std::vector<vtkIdType> sizes;
+    try {
+        for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+            sizes.push_back(SyntheticGrid::parseCellCount(size.trimmed().toStdString()));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+    std::sort(sizes.begin(), sizes.end());
+
+    // 合成メッシュの入力ファイルはベンチマーク終了まで保持する
+    std::shared_ptr<Workspace> inputWorkspace = Workspace::create(Workspace::Backend::Disk);
+    std::vector<CaseResult> results;
+    bool failed = false;
+
+    auto runCase = [&](const BenchCase& benchCase) {
+        CaseResult result;
+        result.benchCase = benchCase;
+        try {
+            for (int i = 0; i < repeat; ++i) {
+                runOnce(benchCase, result, measureWarmLoad);
+            }
+        }
+        catch (const std::exception& e) {
+            result.error = e.what();
+            failed = true;
+        }
+        printCase(result);
+        results.push_back(result);
+    };
+
+    for (const auto& benchCase : cases) {
+        runCase(benchCase);
+    }
+
+    // ピークRSSはプロセス全体の最大値のため、小さいケースから順に実行する
+    for (vtkIdType size : sizes) {
+        BenchCase benchCase;
+        benchCase.name = "synthetic_hex_" + std::to_string(size);
+        benchCase.source = "synthetic";
+        benchCase.vtuFile = inputWorkspace->getFilePath(benchCase.name + ".vtu").string();
+        benchCase.stlFile = inputWorkspace->getFilePath(benchCase.name + ".stl").string();
+
+        std::cout << "\nGenerating " << benchCase.name << "..." << std::endl;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            vtkSmartPointer<vtkUnstructuredGrid> grid = SyntheticGrid::createHexGrid(size);
+            if (!SyntheticGrid::writeVtu(grid, benchCase.vtuFile) || !SyntheticGrid::writeSurfaceStl(grid, benchCase.stlFile)) {
+                std::cerr << "Skipping " << benchCase.name << ": failed to write input files" << std::endl;
+                failed = true;
+                continue;
+            }
+        }
+        benchCase.generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runCase(benchCase);
+
+        // 次のケースのために入力ファイルを削除する
+        std::error_code ec;
+        std::filesystem::remove(benchCase.vtuFile, ec);
+        std::filesystem::remove(benchCase.stlFile, ec);
+    }
+
+    QJsonObject root;
+    root["benchmark"] = "strecs3d-bench";
+    root["formatVersion"] = 1;
+    root["repeat"] = repeat;
+    root["environment"] = environmentToJson();
+    QJsonArray caseArray;
+    for (const auto& result : results) {
+        caseArray.append(caseToJson(result));
+    }
+    root["cases"] = caseArray;
+
+    const QString outputPath = parser.value(outputOption);
+    QFile outputFile(outputPath);
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::cerr << "Error: Failed to write " << outputPath.toStdString() << std::endl;
+        return 1;
+    }
+    outputFile.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    std::cout << "\nResults written to " << outputPath.toStdString() << std::endl;
+    return failed ? 1 : 0;
+}
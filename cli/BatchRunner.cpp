@@ -0,0 +1,362 @@
+#include "BatchRunner.h"
+#include "../core/processing/DatasetCache.h"
+#include "../core/processing/ProcessPipeline.h"
+#include "../core/processing/ResultCache.h"
+#include "../core/processing/VtkProcessor.h"
+#include "../utils/parallelUtility.h"
+#include "../utils/profiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+std::mutex logMutex;
+
+void logLine(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::cout << line << std::endl;
+}
+
+std::string resolvePath(const std::filesystem::path& baseDir, const QString& value)
+{
+    std::filesystem::path path = value.toStdString();
+    if (path.is_relative()) {
+        path = baseDir / path;
+    }
+    return path.lexically_normal().string();
+}
+
+std::vector<double> readNumberArray(const QJsonValue& value, const std::string& key, const std::string& context)
+{
+    if (!value.isArray()) {
+        throw std::runtime_error(context + ": \"" + key + "\" must be an array of numbers");
+    }
+    std::vector<double> numbers;
+    for (const QJsonValue& item : value.toArray()) {
+        if (!item.isDouble()) {
+            throw std::runtime_error(context + ": \"" + key + "\" must be an array of numbers");
+        }
+        numbers.push_back(item.toDouble());
+    }
+    return numbers;
+}
+
+// ジョブ固有の値があればそれを、なければ defaults の値を使う
+QJsonValue lookup(const QJsonObject& job, const QJsonObject& defaults, const char* key)
+{
+    if (job.contains(key)) return job.value(key);
+    return defaults.value(key);
+}
+
+BatchJob parseJob(const QJsonObject& object, const QJsonObject& defaults,
+                  const std::filesystem::path& baseDir, size_t jobIndex)
+{
+    BatchJob job;
+    const std::string context = "Job " + std::to_string(jobIndex + 1);
+
+    const QString vtu = object.value("vtu").toString();
+    const QString stl = object.value("stl").toString();
+    if (vtu.isEmpty() || stl.isEmpty()) {
+        throw std::runtime_error(context + ": \"vtu\" and \"stl\" are required");
+    }
+    job.vtuFile = resolvePath(baseDir, vtu);
+    job.stlFile = resolvePath(baseDir, stl);
+    job.name = object.value("name").toString(
+        QString::fromStdString(std::filesystem::path(job.stlFile).stem().string())).toStdString();
+
+    const QString output = object.value("output").toString();
+    job.outputFile = output.isEmpty()
+        ? (baseDir / (job.name + ".3mf")).lexically_normal().string()
+        : resolvePath(baseDir, output);
+
+    // 荷重ケースはジョブごと、集約方法は defaults でも指定できる
+    const QJsonValue loadCases = object.value("loadCases");
+    if (!loadCases.isUndefined()) {
+        if (!loadCases.isArray()) {
+            throw std::runtime_error(context + ": \"loadCases\" must be an array of file paths");
+        }
+        for (const QJsonValue& item : loadCases.toArray()) {
+            if (!item.isString() || item.toString().isEmpty()) {
+                throw std::runtime_error(context + ": \"loadCases\" must be an array of file paths");
+            }
+            job.loadCaseFiles.push_back(resolvePath(baseDir, item.toString()));
+        }
+    }
+    const QJsonValue envelope = lookup(object, defaults, "envelope");
+    if (!envelope.isUndefined()
+        && !StressEnvelope::parseReduction(envelope.toString().toStdString(), job.envelopeReduction)) {
+        throw std::runtime_error(context + ": unknown envelope \"" + envelope.toString().toStdString()
+                                 + "\" (expected max, absmax or min)");
+    }
+
+    // 応力の求め方と安全率の降伏応力・上限は defaults でも指定できる
+    const QJsonValue stress = lookup(object, defaults, "stress");
+    if (!stress.isUndefined()
+        && !DerivedStress::parseQuantity(stress.toString().toStdString(), job.derivedStress.quantity)) {
+        throw std::runtime_error(context + ": unknown stress \"" + stress.toString().toStdString()
+                                 + "\" (expected auto, vonMises, maxPrincipal, tresca or safetyFactor)");
+    }
+    const QJsonValue yieldStrength = lookup(object, defaults, "yieldStrength");
+    if (!yieldStrength.isUndefined()) {
+        if (!yieldStrength.isDouble()) {
+            throw std::runtime_error(context + ": \"yieldStrength\" must be a number");
+        }
+        job.derivedStress.yieldStrength = yieldStrength.toDouble();
+    }
+    const QJsonValue maxSafetyFactor = lookup(object, defaults, "maxSafetyFactor");
+    if (!maxSafetyFactor.isUndefined()) {
+        if (!maxSafetyFactor.isDouble() || !(maxSafetyFactor.toDouble() > 0.0)) {
+            throw std::runtime_error(context + ": \"maxSafetyFactor\" must be a positive number");
+        }
+        job.derivedStress.maxSafetyFactor = maxSafetyFactor.toDouble();
+    }
+    if (job.derivedStress.quantity == DerivedStress::Quantity::SafetyFactor && !(job.derivedStress.yieldStrength > 0.0)) {
+        throw std::runtime_error(context + ": \"safetyFactor\" requires a positive \"yieldStrength\"");
+    }
+
+    const QJsonValue mode = lookup(object, defaults, "mode");
+    if (!mode.isUndefined()) {
+        job.mode = mode.toString().toStdString();
+    }
+    if (job.mode != "cura" && job.mode != "bambu") {
+        throw std::runtime_error(context + ": unknown mode \"" + job.mode + "\" (expected cura or bambu)");
+    }
+
+    // ジョブにしきい値の指定がなければ defaults の指定を使う（絶対値の指定を比率より優先する）
+    const bool jobHasThresholds = object.contains("thresholds") || object.contains("thresholdRatios");
+    const QJsonObject& thresholdSource = jobHasThresholds ? object : defaults;
+    if (thresholdSource.contains("thresholds")) {
+        job.thresholds = readNumberArray(thresholdSource.value("thresholds"), "thresholds", context);
+    } else if (thresholdSource.contains("thresholdRatios")) {
+        job.thresholds = readNumberArray(thresholdSource.value("thresholdRatios"), "thresholdRatios", context);
+        job.thresholdsAreRatios = true;
+        for (double ratio : job.thresholds) {
+            if (ratio < 0.0 || ratio > 1.0) {
+                throw std::runtime_error(context + ": \"thresholdRatios\" must be between 0 and 1");
+            }
+        }
+    } else {
+        throw std::runtime_error(context + ": \"thresholds\" or \"thresholdRatios\" is required");
+    }
+    if (!std::is_sorted(job.thresholds.begin(), job.thresholds.end())) {
+        throw std::runtime_error(context + ": thresholds must be in ascending order");
+    }
+
+    job.densities = readNumberArray(lookup(object, defaults, "densities"), "densities", context);
+    if (job.densities.size() != job.thresholds.size() + 1) {
+        throw std::runtime_error(context + ": \"densities\" must have one more entry than the thresholds ("
+                                 + std::to_string(job.thresholds.size() + 1) + " expected)");
+    }
+    return job;
+}
+
+} // namespace
+
+BatchManifest BatchRunner::loadManifest(const std::string& manifestPath)
+{
+    QFile file(QString::fromStdString(manifestPath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Failed to open manifest: " + manifestPath);
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        throw std::runtime_error("Failed to parse manifest: " + parseError.errorString().toStdString()
+                                 + " (offset " + std::to_string(parseError.offset) + ")");
+    }
+    if (!document.isObject()) {
+        throw std::runtime_error("Manifest must be a JSON object");
+    }
+
+    const QJsonObject root = document.object();
+    const std::filesystem::path baseDir = std::filesystem::absolute(manifestPath).parent_path();
+
+    BatchManifest manifest;
+    manifest.workers = static_cast<unsigned int>(std::max(0, root.value("workers").toInt(1)));
+    manifest.threadsPerJob = static_cast<unsigned int>(std::max(0, root.value("threadsPerJob").toInt(0)));
+
+    const QJsonObject defaults = root.value("defaults").toObject();
+    const QJsonArray jobs = root.value("jobs").toArray();
+    if (jobs.isEmpty()) {
+        throw std::runtime_error("Manifest has no jobs");
+    }
+    for (int i = 0; i < jobs.size(); ++i) {
+        if (!jobs.at(i).isObject()) {
+            throw std::runtime_error("Job " + std::to_string(i + 1) + ": must be a JSON object");
+        }
+        manifest.jobs.push_back(parseJob(jobs.at(i).toObject(), defaults, baseDir, static_cast<size_t>(i)));
+    }
+    return manifest;
+}
+
+std::vector<double> BatchRunner::resolveThresholds(const BatchJob& job, double minStress, double maxStress)
+{
+    std::vector<double> boundaries;
+    boundaries.push_back(minStress);
+    for (double threshold : job.thresholds) {
+        double value = threshold;
+        if (job.thresholdsAreRatios) {
+            value = minStress + (maxStress - minStress) * threshold;
+        } else if (value < minStress || value > maxStress) {
+            throw std::runtime_error("Threshold " + std::to_string(value) + " is outside the stress range ["
+                                     + std::to_string(minStress) + ", " + std::to_string(maxStress) + "]");
+        }
+        boundaries.push_back(value);
+    }
+    boundaries.push_back(maxStress);
+    return boundaries;
+}
+
+std::vector<StressDensityMapping> BatchRunner::createMappings(const std::vector<double>& boundaries,
+                                                              const std::vector<double>& densities)
+{
+    std::vector<StressDensityMapping> mappings;
+    for (size_t i = 0; i + 1 < boundaries.size() && i < densities.size(); ++i) {
+        mappings.push_back({boundaries[i], boundaries[i + 1], densities[i]});
+    }
+    return mappings;
+}
+
+std::string BatchRunner::makeResultCacheKey(const BatchJob& job)
+{
+    ResultCache::KeyBuilder key;
+    auto addDataset = [&key](const std::string& file) {
+        if (!key.addFileContent(file)) {
+            return false;
+        }
+        if (!VtkProcessor::isPartitionedFile(file)) {
+            return true;
+        }
+        const std::vector<std::string> pieceFiles = VtkProcessor::getPieceFileNames(file);
+        if (pieceFiles.empty()) {
+            return false;
+        }
+        for (const auto& pieceFile : pieceFiles) {
+            if (!key.addFileContent(pieceFile)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!addDataset(job.vtuFile) || !key.addFileContent(job.stlFile)) {
+        return "";
+    }
+    if (!job.loadCaseFiles.empty()) {
+        for (const auto& caseFile : job.loadCaseFiles) {
+            if (!addDataset(caseFile)) {
+                return "";
+            }
+        }
+        key.addString(StressEnvelope::getReductionName(job.envelopeReduction));
+    }
+    if (!job.derivedStress.getKey().empty()) {
+        key.addString(job.derivedStress.getKey());
+    }
+    key.addString("batch");
+    key.addString(std::filesystem::path(job.stlFile).filename().string());
+    key.addDouble(job.thresholdsAreRatios ? 1.0 : 0.0);
+    key.addDoubles(job.thresholds);
+    key.addDoubles(job.densities);
+    key.addString(job.mode);
+    return key.build();
+}
+
+BatchJobResult BatchRunner::runJob(const BatchJob& job, bool useResultCache)
+{
+    BatchJobResult result;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        Profiler::Scope profile("Batch job");
+        ProcessPipeline pipeline;
+
+        // 同じ入力・条件の結果がキャッシュにあれば、読み込み・分割・3MF作成をすべて省略する
+        const std::string cacheKey = useResultCache ? makeResultCacheKey(job) : std::string();
+        if (!cacheKey.empty() && pipeline.restoreCachedResult(cacheKey, job.outputFile)) {
+            result.success = true;
+            result.message = job.outputFile + " (cached)";
+            result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        }
+
+        pipeline.setLoadCaseFiles(job.loadCaseFiles, job.envelopeReduction);
+        pipeline.setDerivedStress(job.derivedStress);
+        if (!pipeline.initializeVtkProcessor(job.vtuFile, job.stlFile, {})) {
+            throw std::runtime_error("Failed to load VTK file: " + job.vtuFile);
+        }
+
+        // 比率で指定されたしきい値は読み込んだ応力範囲から求める
+        auto& vtkProcessor = pipeline.getVtkProcessor();
+        const std::vector<double> boundaries =
+            resolveThresholds(job, vtkProcessor->getMinStress(), vtkProcessor->getMaxStress());
+        vtkProcessor->prepareStressValues(boundaries);
+
+        pipeline.processMeshDivision();
+        profile.addCount("bands", static_cast<std::int64_t>(pipeline.getDividedMeshes().size()));
+
+        const std::vector<StressDensityMapping> mappings = createMappings(boundaries, job.densities);
+        if (!pipeline.process3mfFile(job.mode, mappings, pipeline.getMaxStress(), job.outputFile)) {
+            throw std::runtime_error("Failed to write 3MF file: " + job.outputFile);
+        }
+        pipeline.storeCachedResult(cacheKey, job.outputFile);
+        result.success = true;
+        result.message = job.outputFile;
+    }
+    catch (const std::exception& e) {
+        result.success = false;
+        result.message = e.what();
+    }
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<BatchJobResult> BatchRunner::runAll(const BatchManifest& manifest)
+{
+    const size_t jobCount = manifest.jobs.size();
+    std::vector<BatchJobResult> results(jobCount);
+    const unsigned int workers = manifest.workers > 0
+        ? manifest.workers
+        : std::max(1u, std::thread::hardware_concurrency());
+    // ジョブ内の並列処理（バンドごとのクリップなど）が使うスレッド数
+    // 外側のジョブ並列にはワーカー数を明示するため、各ジョブには既定値がそのまま割り当てられる
+    // 未指定の場合はハードウェアスレッドをジョブ間で分け、スレッド数の過剰を避ける
+    const unsigned int threadsPerJob = manifest.threadsPerJob > 0
+        ? manifest.threadsPerJob
+        : std::max(1u, std::thread::hardware_concurrency() / workers);
+    ParallelUtility::setWorkerCount(threadsPerJob);
+
+    // 同じファイルを使うジョブ間では読み込み結果を共有しつつ、
+    // 処理中のジョブのVTUとSTL（荷重ケースがあれば各ケースと包絡値）以上はデータセットを保持しないようにする
+    size_t datasetsPerJob = 2;
+    for (const auto& job : manifest.jobs) {
+        if (!job.loadCaseFiles.empty()) {
+            datasetsPerJob = std::max(datasetsPerJob, job.loadCaseFiles.size() + 3);
+        }
+    }
+    DatasetCache::instance().setMaxEntries(static_cast<size_t>(workers) * datasetsPerJob);
+
+    ParallelUtility::parallelFor(jobCount, workers, [&](size_t i) {
+        const BatchJob& job = manifest.jobs[i];
+        const std::string label = "[" + std::to_string(i + 1) + "/" + std::to_string(jobCount) + "] " + job.name;
+        logLine(label + ": started");
+        results[i] = runJob(job, manifest.useResultCache);
+        if (results[i].success) {
+            logLine(label + ": done in " + std::to_string(results[i].elapsedSeconds) + " s -> " + results[i].message);
+        } else {
+            logLine(label + ": FAILED: " + results[i].message);
+        }
+    });
+    return results;
+}
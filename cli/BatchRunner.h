@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../core/processing/StressDensityMapping.h"
+#include "../core/processing/StressEnvelope.h"
+#include "../core/processing/DerivedStress.h"
+
+// バッチ処理の1ジョブ分の設定（VTU/STLの組と分割条件）
+struct BatchJob {
+    std::string name;
+    std::string vtuFile;
+    // vtuFile と同じメッシュの別の荷重ケース（指定した場合は全ケースの包絡値で分割する）
+    std::vector<std::string> loadCaseFiles;
+    StressEnvelope::Reduction envelopeReduction = StressEnvelope::Reduction::Maximum;
+    // テンソルのみを出力するソルバーの結果から求める応力（既定は自動）
+    DerivedStress::Settings derivedStress;
+    std::string stlFile;
+    std::string outputFile;
+    std::string mode = "cura";
+    // バンド境界（最小値・最大値を除く内側のしきい値、昇順）
+    std::vector<double> thresholds;
+    // true の場合 thresholds は応力範囲に対する比率（0〜1）
+    bool thresholdsAreRatios = false;
+    // バンドごとの密度（低応力側から、要素数 = しきい値数 + 1）
+    std::vector<double> densities;
+};
+
+// ジョブマニフェスト（JSON）の内容
+struct BatchManifest {
+    unsigned int workers = 1;        // 同時に処理するジョブ数（0 の場合はハードウェアスレッド数）
+    unsigned int threadsPerJob = 0;  // ジョブ内の並列処理に使うスレッド数（0 の場合はハードウェアスレッド数 / workers）
+    bool useResultCache = true;      // 同じ入力・条件の過去の結果を ResultCache から再利用する
+    std::vector<BatchJob> jobs;
+};
+
+// ジョブ1件の処理結果
+struct BatchJobResult {
+    bool success = false;
+    std::string message;
+    double elapsedSeconds = 0.0;
+};
+
+// GUIを使わずに複数のVTU/STLの組を処理するクラス
+class BatchRunner {
+public:
+    // マニフェストを読み込む（相対パスはマニフェストのディレクトリを基準に解決する）
+    // 読み込みや内容の検証に失敗した場合は std::runtime_error を送出する
+    static BatchManifest loadManifest(const std::string& manifestPath);
+
+    // 1ジョブを処理する（例外は送出せず結果に格納する）
+    // useResultCache が true の場合は ResultCache の結果を再利用し、処理した結果を保存する
+    static BatchJobResult runJob(const BatchJob& job, bool useResultCache = false);
+
+    // 全ジョブを workers 件ずつ並列に処理する（結果はジョブの順）
+    // ジョブ内の並列処理のスレッド数（ParallelUtility::setWorkerCount）もここで設定する
+    static std::vector<BatchJobResult> runAll(const BatchManifest& manifest);
+
+    // 応力範囲と内側のしきい値から [最小値, しきい値..., 最大値] を作成する
+    static std::vector<double> resolveThresholds(const BatchJob& job, double minStress, double maxStress);
+
+    // ジョブの入力ファイルの内容と条件から結果キャッシュのキーを求める
+    // しきい値を比率で指定できるため、VTUを読み込む前に求められるよう指定値のままハッシュする
+    static std::string makeResultCacheKey(const BatchJob& job);
+
+    // 境界値と密度からバンドごとのマッピングを作成する
+    static std::vector<StressDensityMapping> createMappings(const std::vector<double>& boundaries,
+                                                            const std::vector<double>& densities);
+};
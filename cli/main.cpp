@@ -0,0 +1,105 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "BatchRunner.h"
+#include "../core/processing/ResultCache.h"
+#include "../utils/profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+// GUIを使わずにジョブマニフェストに記載されたVTU/STLの組を一括処理する
+//
+// マニフェストの例:
+// {
+//   "workers": 4,
+//   "threadsPerJob": 2,
+//   "defaults": { "mode": "cura", "thresholdRatios": [0.25, 0.5, 0.75], "densities": [10, 20, 40, 80] },
+//   "jobs": [
+//     { "vtu": "parts/bracket.vtu", "stl": "parts/bracket.stl", "output": "out/bracket.3mf" },
+//     { "vtu": "parts/hinge.vtu", "stl": "parts/hinge.stl", "mode": "bambu",
+//       "thresholds": [1.5e6, 3.0e6], "densities": [15, 30, 60] },
+//     { "vtu": "parts/frame-case1.vtu", "loadCases": ["parts/frame-case2.vtu", "parts/frame-case3.vtu"],
+//       "envelope": "max", "stl": "parts/frame.stl" }
+//   ]
+// }
+// loadCases を指定したジョブは、vtu と各荷重ケースの応力を点ごとに集約した包絡値（envelope:
+// max / absmax / min、既定は max）で応力範囲としきい値を求めて分割する
+// "stress" にはテンソル（または Sxx などの成分配列）から求める応力を指定できる
+// （auto / vonMises / maxPrincipal / tresca / safetyFactor、safetyFactor は "yieldStrength" も必要）
+// safetyFactor は値が大きいほど応力が小さく、"maxSafetyFactor"（既定 10）で頭打ちにする
+// auto（既定）はスカラーの応力配列を使い、テンソルしかない場合のみミーゼス応力を求める
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("Strecs3D");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Process VTU/STL pairs listed in a job manifest without the GUI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("manifest", "Job manifest (JSON).");
+    QCommandLineOption workersOption({"w", "workers"},
+        "Number of jobs processed concurrently (0 = hardware threads). Overrides the manifest.", "count");
+    QCommandLineOption threadsOption({"t", "threads"},
+        "Number of threads used inside each job (0 = hardware threads / workers). Overrides the manifest.", "count");
+    QCommandLineOption profileOption("profile", "Print the per-stage timing summary after all jobs finish.");
+    QCommandLineOption noCacheOption("no-cache", "Always process every job instead of reusing cached results.");
+    parser.addOption(workersOption);
+    parser.addOption(threadsOption);
+    parser.addOption(profileOption);
+    parser.addOption(noCacheOption);
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1) {
+        parser.showHelp(2);
+    }
+
+    BatchManifest manifest;
+    try {
+        manifest = BatchRunner::loadManifest(arguments.first().toStdString());
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+    if (parser.isSet(workersOption)) {
+        manifest.workers = parser.value(workersOption).toUInt();
+    }
+    if (parser.isSet(threadsOption)) {
+        manifest.threadsPerJob = parser.value(threadsOption).toUInt();
+    }
+    manifest.useResultCache = ResultCache::isEnabled() && !parser.isSet(noCacheOption);
+
+    Profiler::beginSession();
+    std::vector<BatchJobResult> results;
+    {
+        Profiler::Scope profile("Batch");
+        profile.addCount("jobs", static_cast<std::int64_t>(manifest.jobs.size()));
+        results = BatchRunner::runAll(manifest);
+    }
+
+    std::vector<Profiler::Record> records = Profiler::takeRecords();
+    if (parser.isSet(profileOption)) {
+        std::cout << Profiler::formatSummary(records) << std::endl;
+    }
+    const std::string tracePath = Profiler::getTraceOutputPath();
+    if (!tracePath.empty()) {
+        if (Profiler::writeChromeTrace(records, tracePath)) {
+            std::cout << "Chrome trace written: " << tracePath << std::endl;
+        } else {
+            std::cerr << "Failed to write Chrome trace: " << tracePath << std::endl;
+        }
+    }
+
+    const size_t failed = static_cast<size_t>(std::count_if(results.begin(), results.end(),
+        [](const BatchJobResult& result) { return !result.success; }));
+    std::cout << (results.size() - failed) << " of " << results.size() << " jobs succeeded" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].success) {
+            std::cerr << "  FAILED " << manifest.jobs[i].name << ": " << results[i].message << std::endl;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
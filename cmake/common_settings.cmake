@@ -17,7 +17,7 @@ else()
 endif()
 
 # Qt6の検索
-find_package(Qt6 REQUIRED COMPONENTS Core Widgets)
+find_package(Qt6 REQUIRED COMPONENTS Core Gui Widgets)
 
 # Qt6の詳細設定
 if(Qt6_FOUND)
@@ -90,6 +90,40 @@ else()
   message(FATAL_ERROR "VTK not found. Please install via vcpkg: vcpkg install vtk[qt]")
 endif()
 
+# GUI・コマンドライン版・ベンチマークが共有する処理コア（一度だけコンパイルして各ターゲットにリンクする）
+# 処理コアは QtWidgets に依存しない
+# （VtkProcessor が ColorManager の QColor を使うため Qt6::Gui はリンクする）
+add_library(strecs3d_core STATIC
+  UI/ColorManager.cpp
+  core/processing/VtkProcessor.cpp
+  core/processing/DatasetCache.cpp
+  core/processing/DerivedStress.cpp
+  core/processing/ProcessControl.cpp
+  core/processing/ResultCache.cpp
+  core/processing/VtuBinaryCache.cpp
+  core/processing/StressBandDivider.cpp
+  core/processing/StressEnvelope.cpp
+  core/processing/StressIntervalIndex.cpp
+  core/processing/Workspace.cpp
+  core/processing/lib3mfProcessor.cpp
+  core/processing/AppendedVtuReader.cpp
+  core/processing/MappedDataArray.cpp
+  core/processing/ProcessPipeline.cpp
+  utils/fileUtility.cpp
+  utils/mappedFile.cpp
+  utils/parallelUtility.cpp
+  utils/profiler.cpp
+  utils/tempPathUtility.cpp
+  utils/xmlConverter.cpp
+)
+target_link_libraries(strecs3d_core PUBLIC
+  Qt6::Core
+  Qt6::Gui
+  ${VTK_LIBRARIES}
+  lib3mf::lib3mf
+  libzip::zip
+)
+
 # 実行可能ファイルの生成
 add_executable(Strecs3D
   main.cpp
@@ -97,28 +131,23 @@ add_executable(Strecs3D
   UI/mainwindowui.cpp
   UI/widgets/MessageConsole.cpp
   UI/widgets/DensitySlider.cpp
-  UI/ColorManager.cpp
   UI/widgets/Button.cpp
   UI/widgets/ModeComboBox.cpp
   UI/widgets/ObjectDisplayOptionsWidget.cpp
   UI/widgets/DisplayOptionsContainer.cpp
   UI/widgets/CustomCheckBox.cpp
   UI/SceneRenderer.cpp
-  core/processing/VtkProcessor.cpp
-  core/processing/lib3mfProcessor.cpp
-  utils/fileUtility.cpp
-  utils/tempPathUtility.cpp
-  utils/xmlConverter.cpp
   core/application/ApplicationController.cpp
   core/application/MainWindowUIAdapter.cpp
   core/interfaces/IUserInterface.cpp
-  core/processing/ProcessPipeline.cpp
   core/visualization/VisualizationManager.cpp
   core/visualization/SceneDataController.cpp
   core/export/ExportManager.cpp
   resources/resources.qrc
 )
 
+target_link_libraries(Strecs3D PRIVATE strecs3d_core)
+
 # OS別の設定を適用
 if(WIN32)
   apply_windows_settings(Strecs3D)
@@ -126,10 +155,49 @@ elseif(APPLE)
   apply_macos_settings(Strecs3D)
 endif()
 
+# GUIを使わないターゲットのリンク設定
+function(apply_headless_settings TARGET_NAME)
+  target_link_libraries(${TARGET_NAME} PRIVATE
+    Qt6::Core
+    Qt6::Gui
+    ${VTK_LIBRARIES}
+    lib3mf::lib3mf
+  )
+  if(APPLE)
+    set_target_properties(${TARGET_NAME} PROPERTIES
+      BUILD_WITH_INSTALL_RPATH TRUE
+      INSTALL_RPATH_USE_LINK_PATH TRUE
+    )
+  endif()
+endfunction()
+
+# コマンドライン版（GUIなしでジョブマニフェストを一括処理する）
+add_executable(strecs3d-cli
+  cli/main.cpp
+  cli/BatchRunner.cpp
+)
+target_link_libraries(strecs3d-cli PRIVATE strecs3d_core)
+apply_headless_settings(strecs3d-cli)
+
+# ベンチマーク（同梱サンプルと合成メッシュで各処理段階を計測し、結果をJSONで出力する）
+add_executable(strecs3d-bench
+  benchmarks/main.cpp
+  benchmarks/SyntheticGrid.cpp
+)
+target_link_libraries(strecs3d-bench PRIVATE strecs3d_core)
+apply_headless_settings(strecs3d-bench)
+
+# 合成メッシュ生成ツール（スケーリング試験用のVTUとSTLを出力する）
+add_executable(strecs3d-generate
+  benchmarks/generate.cpp
+  benchmarks/SyntheticGrid.cpp
+)
+apply_headless_settings(strecs3d-generate)
+
 # VTK 自動初期化設定 (VTK バージョンが 8.90.0 以上の場合)
 if(VTK_VERSION VERSION_GREATER_EQUAL "8.90.0")
   vtk_module_autoinit(
-    TARGETS Strecs3D
+    TARGETS strecs3d_core Strecs3D strecs3d-cli strecs3d-bench strecs3d-generate
     MODULES ${VTK_LIBRARIES}
   )
 endif()
@@ -151,6 +219,11 @@ install(TARGETS Strecs3D
   ARCHIVE DESTINATION ${CMAKE_INSTALL_LIBDIR}
 )
 
+# コマンドライン版をインストール
+install(TARGETS strecs3d-cli
+  RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR}
+)
+
 # 念のためターゲットファイルを直接コピー（GUIアプリでも確実に拾う保険）
 install(
   FILES
@@ -4,6 +4,10 @@
 #include "../../utils/fileUtility.h"
 #include "../../utils/tempPathUtility.h"
 #include "../processing/VtkProcessor.h"
+#include "../processing/ProcessControl.h"
+#include "../processing/Workspace.h"
+#include "../processing/ResultCache.h"
+#include "../../utils/profiler.h"
 #include <iostream>
 #include <stdexcept>
 
@@ -12,7 +16,31 @@ ApplicationController::ApplicationController(QObject* parent)
     , fileProcessor(std::make_unique<ProcessPipeline>())
     , visualizationManager(nullptr)
     , exportManager(std::make_unique<ExportManager>())
+    , processingPipeline(std::make_shared<ProcessPipeline>())
 {
+    // ワーカースレッドからの完了通知はGUIスレッドで処理する
+    connect(this, &ApplicationController::workerFinished,
+            this, &ApplicationController::handleWorkerFinished, Qt::QueuedConnection);
+
+    speculationTimer.setSingleShot(true);
+    speculationTimer.setInterval(SPECULATION_DELAY_MS);
+    connect(&speculationTimer, &QTimer::timeout, this, &ApplicationController::startSpeculativeDivision);
+}
+
+ApplicationController::~ApplicationController()
+{
+    // 処理中のワーカースレッドがあればキャンセルして終了を待つ
+    if (workerThread) {
+        cancelProcessing();
+        workerThread->wait();
+    }
+    // バックグラウンド処理もキャンセルして終了を待つ
+    preparationPending = false;
+    discardSpeculativeDivision();
+    if (backgroundThread) {
+        backgroundControl->requestCancel();
+        backgroundThread->wait();
+    }
 }
 
 void ApplicationController::initializeVisualizationManager(IUserInterface* ui)
@@ -22,11 +50,18 @@ void ApplicationController::initializeVisualizationManager(IUserInterface* ui)
     }
 }
 
-bool ApplicationController::openVtkFile(const std::string& vtkFile, IUserInterface* ui)
+bool ApplicationController::openVtkFile(const std::string& vtkFile, IUserInterface* ui,
+                                        const std::vector<std::string>& loadCaseFiles)
 {
     if (!ui) return false;
+    if (isProcessing()) {
+        emit showWarningMessage("Warning", "Cannot open a file while processing");
+        return false;
+    }
     
     setVtkFile(vtkFile);
+    this->loadCaseFiles = loadCaseFiles;
+    fileProcessor->setLoadCaseFiles(loadCaseFiles);
     
     // VTK用ObjectDisplayOptionsWidgetのファイル名を更新
     emit vtkFileNameChanged(QString::fromStdString(vtkFile));
@@ -51,6 +86,11 @@ bool ApplicationController::openVtkFile(const std::string& vtkFile, IUserInterfa
                 fileProcessor->getVtkProcessor()->getMaxStress()
             );
         }
+        // 新しいカラーテーブルにもプレビューを反映する
+        updateBandPreview(ui);
+        scheduleSpeculativeDivision(ui);
+        // 処理用のデータとインデックスを、STLや密度の設定中にバックグラウンドで準備する
+        startPreparation();
         
         return true;
     }
@@ -63,6 +103,10 @@ bool ApplicationController::openVtkFile(const std::string& vtkFile, IUserInterfa
 bool ApplicationController::openStlFile(const std::string& stlFile, IUserInterface* ui)
 {
     if (!ui) return false;
+    if (isProcessing()) {
+        emit showWarningMessage("Warning", "Cannot open a file while processing");
+        return false;
+    }
     
     setStlFile(stlFile);
     setCurrentStlFilename(QString::fromStdString(stlFile));
@@ -74,6 +118,7 @@ bool ApplicationController::openStlFile(const std::string& stlFile, IUserInterfa
         if (visualizationManager) {
             visualizationManager->displayStlFile(stlFile, fileProcessor->getVtkProcessor().get());
         }
+        scheduleSpeculativeDivision(ui);
         return true;
     }
     catch (const std::exception& e) {
@@ -84,36 +129,43 @@ bool ApplicationController::openStlFile(const std::string& stlFile, IUserInterfa
 
 bool ApplicationController::processFiles(IUserInterface* ui)
 {
+    if (isProcessing()) {
+        return false;
+    }
     try {
         // Step 1: Validate input files
         if (!validateFiles(ui)) {
             return false;
         }
         
-        // Step 2: Initialize VTK processor with stress thresholds
-        if (!initializeVtkProcessor(ui)) {
-            return false;
-        }
+        // UIからの値の取得はGUIスレッドで行い、ワーカースレッドには値のみを渡す
+        ProcessRequest request;
+        request.vtkFile = vtkFile;
+        request.loadCaseFiles = loadCaseFiles;
+        request.stlFile = stlFile;
+        request.thresholds = getStressThresholds(ui);
+        request.mappings = getStressDensityMappings(ui);
+        request.mode = getCurrentMode(ui).toStdString();
         
-        // Step 3: Process mesh division
-        if (!processMeshDivision(ui)) {
-            return false;
-        }
-        
-        // Step 4: Process 3MF file generation
-        if (!process3mfGeneration(ui)) {
-            return false;
-        }
-        
-        // Step 5: Load and display temporary STL files
-        loadAndDisplayTempStlFiles(ui);
+        // 同じ入力の投機的な分割が完了していれば引き継ぎ、3MFの作成のみを行う
+        request.divisionReady = adoptSpeculativeDivision(request);
         
-        // Step 6: Cleanup temporary files
-        cleanupTempFiles();
-        
-        // Step 7: Show success message
-        showSuccessMessage(ui);
+        // 実行ごとに新しい作業領域を使い、前回の結果は成功するまで保持する
+        fileProcessor->setWorkspace(Workspace::create());
+
+        processingUi = ui;
+        processControl = std::make_shared<ProcessControl>();
+        processControl->setProgressCallback([this](const std::string& stage, int percent) {
+            emit processingProgress(QString::fromStdString(stage), percent);
+        });
         
+        // Step 2-4 はワーカースレッドで実行し、完了時に workerFinished でGUIスレッドへ戻る
+        std::shared_ptr<ProcessControl> control = processControl;
+        workerThread = QThread::create([this, control, request]() {
+            runPipeline(control, request);
+        });
+        connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
+        workerThread->start();
         return true;
     }
     catch (const std::exception& e) {
@@ -122,6 +174,251 @@ bool ApplicationController::processFiles(IUserInterface* ui)
     }
 }
 
+void ApplicationController::cancelProcessing()
+{
+    if (processControl) {
+        processControl->requestCancel();
+    }
+}
+
+void ApplicationController::scheduleSpeculativeDivision(IUserInterface* ui)
+{
+    // しきい値や入力が変わった時点で以前の結果は古くなる
+    discardSpeculativeDivision();
+    if (!ui || vtkFile.empty() || stlFile.empty() || isProcessing()) return;
+    speculationUi = ui;
+    speculationTimer.start();
+}
+
+void ApplicationController::discardSpeculativeDivision()
+{
+    speculationTimer.stop();
+    if (backgroundThread && backgroundTask == BackgroundTask::SpeculativeDivision) {
+        backgroundControl->requestCancel();
+    }
+    speculativeReady = false;
+}
+
+void ApplicationController::startPreparation()
+{
+    if (vtkFile.empty() || isProcessing()) return;
+    if (backgroundThread) {
+        // 実行中のタスクは以前の入力に対するものなので止め、終了後に準備を始める
+        backgroundControl->requestCancel();
+        preparationPending = true;
+        return;
+    }
+    ProcessRequest request;
+    request.vtkFile = vtkFile;
+    request.loadCaseFiles = loadCaseFiles;
+    startBackgroundTask(BackgroundTask::Preparation, request);
+}
+
+void ApplicationController::startSpeculativeDivision()
+{
+    if (!speculationUi || isProcessing()) return;
+    if (backgroundThread || preparationPending) {
+        // 準備や以前の分割が終了していない場合は待ってから再試行する
+        speculationTimer.start();
+        return;
+    }
+
+    ProcessRequest request;
+    request.vtkFile = vtkFile;
+    request.loadCaseFiles = loadCaseFiles;
+    request.stlFile = stlFile;
+    request.thresholds = getStressThresholds(speculationUi);
+    if (request.thresholds.size() < 2) return;
+    startBackgroundTask(BackgroundTask::SpeculativeDivision, request);
+}
+
+void ApplicationController::startBackgroundTask(BackgroundTask task, const ProcessRequest& request)
+{
+    // 表示用の VtkProcessor とは別のパイプラインで実行し、完了後にGUIスレッドで受け取る
+    // 読み込んだデータは DatasetCache で共有されるため、表示で読み込み済みのファイルは再パースしない
+    std::shared_ptr<ProcessPipeline> pipeline = processingPipeline;
+    auto control = std::make_shared<ProcessControl>();
+    backgroundTask = task;
+    backgroundControl = control;
+    backgroundThread = QThread::create([this, pipeline, control, task, request]() {
+        bool succeeded = false;
+        {
+            std::lock_guard<std::mutex> lock(processingPipelineMutex);
+            pipeline->setProcessControl(control.get());
+            pipeline->setLoadCaseFiles(request.loadCaseFiles);
+            try {
+                if (task == BackgroundTask::Preparation) {
+                    succeeded = pipeline->prepareVtkData(request.vtkFile);
+                } else {
+                    succeeded = pipeline->initializeVtkProcessor(request.vtkFile, request.stlFile, request.thresholds)
+                                && !pipeline->processMeshDivision().empty();
+                }
+            }
+            catch (const ProcessCancelledError&) {
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Background processing failed: " << e.what() << std::endl;
+            }
+            pipeline->setProcessControl(nullptr);
+        }
+        QMetaObject::invokeMethod(this, [this, task, control, request, succeeded]() {
+            handleBackgroundTaskFinished(task, control, request, succeeded);
+        }, Qt::QueuedConnection);
+    });
+    connect(backgroundThread, &QThread::finished, backgroundThread, &QObject::deleteLater);
+    // 投機的な分割は操作中のGUIや本処理を妨げないよう低い優先度で実行する
+    backgroundThread->start(task == BackgroundTask::SpeculativeDivision ? QThread::LowPriority
+                                                                        : QThread::NormalPriority);
+}
+
+void ApplicationController::handleBackgroundTaskFinished(BackgroundTask task, std::shared_ptr<ProcessControl> control,
+                                                         const ProcessRequest& request, bool succeeded)
+{
+    if (backgroundThread) {
+        backgroundThread->wait();
+        backgroundThread = nullptr;
+    }
+    backgroundControl.reset();
+
+    // 実行中に入力やしきい値が変わった場合（キャンセル済み）は結果を破棄する
+    if (succeeded && !control->isCancelled()) {
+        if (task == BackgroundTask::Preparation) {
+            std::cout << "VTK data prepared for processing: " << request.vtkFile << std::endl;
+        } else {
+            speculativeRequest = request;
+            speculativeReady = true;
+            std::cout << "Speculative division ready (" << processingPipeline->getDividedMeshes().size()
+                      << " meshes)" << std::endl;
+        }
+    }
+
+    if (preparationPending) {
+        preparationPending = false;
+        startPreparation();
+    }
+}
+
+bool ApplicationController::adoptSpeculativeDivision(const ProcessRequest& request)
+{
+    const bool matches = speculativeReady && !backgroundThread
+        && speculativeRequest.vtkFile == request.vtkFile
+        && speculativeRequest.loadCaseFiles == request.loadCaseFiles
+        && speculativeRequest.stlFile == request.stlFile
+        && speculativeRequest.thresholds == request.thresholds;
+    if (matches) {
+        fileProcessor->adoptDivision(*processingPipeline);
+    }
+    // 本処理と並行して分割しないよう、実行中の投機的な分割は止める
+    // 実行中の準備は止めず、本処理がその完了を待って結果を使う
+    discardSpeculativeDivision();
+    preparationPending = false;
+    return matches;
+}
+
+void ApplicationController::runPipeline(std::shared_ptr<ProcessControl> control, ProcessRequest request)
+{
+    ProcessStatus status = ProcessStatus::Succeeded;
+    QString message;
+    fileProcessor->setProcessControl(control.get());
+    Profiler::beginSession();
+    {
+        Profiler::Scope profile("Process files");
+        try {
+            // 入力と条件が同じ過去の結果があれば、分割と3MF作成をすべて省略する
+            std::string cacheKey;
+            bool cached = false;
+            if (ResultCache::isEnabled()) {
+                control->beginStage("Checking result cache", 0, 0);
+                cacheKey = ProcessPipeline::makeResultCacheKey(request.vtkFile, request.stlFile, request.thresholds,
+                                                               request.mappings, request.mode,
+                                                               request.loadCaseFiles);
+                cached = fileProcessor->restoreCachedResult(cacheKey);
+            }
+            
+            if (cached) {
+                control->beginStage("Using cached result", 0, 100);
+            } else {
+                if (!request.divisionReady) {
+                    // Step 2-3: 読み込みと分割を行い、結果を fileProcessor に引き継ぐ
+                    divideOnProcessingPipeline(control.get(), request);
+                }
+                
+                // Step 4: Process 3MF file generation
+                control->beginStage("Writing 3MF file", request.divisionReady ? 0 : 60, 100);
+                process3mfGeneration(request);
+                if (!cacheKey.empty()) {
+                    fileProcessor->storeCachedResult(cacheKey);
+                }
+            }
+            control->reportProgress(1.0);
+        }
+        catch (const ProcessCancelledError&) {
+            status = ProcessStatus::Cancelled;
+        }
+        catch (const std::exception& e) {
+            status = ProcessStatus::Failed;
+            message = e.what();
+        }
+    }
+    reportProfile();
+    fileProcessor->setProcessControl(nullptr);
+    emit workerFinished(static_cast<int>(status), message);
+}
+
+void ApplicationController::reportProfile()
+{
+    // 各段階の計測結果をメッセージコンソールへ送り、必要に応じてトレースを書き出す
+    std::vector<Profiler::Record> records = Profiler::takeRecords();
+    if (records.empty()) return;
+    QString report = QString::fromStdString(Profiler::formatSummary(records));
+
+    const std::string tracePath = Profiler::getTraceOutputPath();
+    if (!tracePath.empty()) {
+        if (Profiler::writeChromeTrace(records, tracePath)) {
+            report += "Chrome trace written: " + QString::fromStdString(tracePath);
+        } else {
+            report += "Failed to write Chrome trace: " + QString::fromStdString(tracePath);
+        }
+    }
+    std::cout << report.toStdString() << std::endl;
+    emit processingReport(report);
+}
+
+void ApplicationController::handleWorkerFinished(int status, const QString& message)
+{
+    // QThread は finished 後に deleteLater で破棄される
+    if (workerThread) {
+        workerThread->wait();
+        workerThread = nullptr;
+    }
+    processControl.reset();
+    IUserInterface* ui = processingUi;
+    processingUi = nullptr;
+    const bool hadPreview = previewDisplayed;
+    previewDisplayed = false;
+
+    switch (static_cast<ProcessStatus>(status)) {
+    case ProcessStatus::Succeeded:
+        resultWorkspace = fileProcessor->getWorkspace();
+        // Step 5: Display divided meshes
+        loadAndDisplayDividedMeshes(ui);
+        // Step 6: Show success message
+        showSuccessMessage(ui);
+        emit processingFinished(true, false);
+        break;
+    case ProcessStatus::Cancelled:
+        std::cout << "Processing cancelled" << std::endl;
+        if (hadPreview) restoreVtkDisplay();
+        emit processingFinished(false, true);
+        break;
+    case ProcessStatus::Failed:
+        if (hadPreview) restoreVtkDisplay();
+        handleProcessingError(std::runtime_error(message.toStdString()), ui);
+        emit processingFinished(false, false);
+        break;
+    }
+}
+
 bool ApplicationController::validateFiles(IUserInterface* ui)
 {
     if (!ui) return false;
@@ -137,48 +434,73 @@ bool ApplicationController::validateFiles(IUserInterface* ui)
     return true;
 }
 
-bool ApplicationController::initializeVtkProcessor(IUserInterface* ui)
+void ApplicationController::divideOnProcessingPipeline(ProcessControl* control, const ProcessRequest& request)
 {
-    if (!ui) return false;
-    
-    auto thresholds = getStressThresholds(ui);
-    if (!fileProcessor->initializeVtkProcessor(vtkFile, stlFile, thresholds, nullptr)) {
-        emit showCriticalMessage("Error", "Failed to initialize VTK processor");
-        return false;
+    control->beginStage("Loading VTK file", 0, 30);
+    // バックグラウンドの準備が実行中であれば、ここで完了を待ってから準備済みのデータを使う
+    std::lock_guard<std::mutex> lock(processingPipelineMutex);
+    processingPipeline->setProcessControl(control);
+    try {
+        // Step 2: Initialize VTK processor with stress thresholds
+        initializeVtkProcessor(request);
+        
+        // 大きなデータでは外表面のみを分割した粗い結果を先に表示し、完了時に正確な分割結果へ差し替える
+        // 3MFは常に下の完全な分割結果から作成する
+        int divisionStart = 30;
+        if (processingPipeline->getVtkProcessor()->getCellCount() >= PROGRESSIVE_MIN_CELLS) {
+            control->beginStage("Previewing bands", 30, 35);
+            std::vector<DividedMesh> preview = processingPipeline->processPreviewDivision();
+            QMetaObject::invokeMethod(this, [this, preview]() {
+                displayDividedMeshes(preview, processingUi);
+                previewDisplayed = true;
+            }, Qt::QueuedConnection);
+            divisionStart = 35;
+        }
+        
+        // Step 3: Process mesh division
+        control->beginStage("Dividing mesh", divisionStart, 60);
+        processMeshDivision();
     }
-    return true;
+    catch (...) {
+        processingPipeline->setProcessControl(nullptr);
+        throw;
+    }
+    processingPipeline->setProcessControl(nullptr);
+    fileProcessor->adoptDivision(*processingPipeline);
 }
 
-bool ApplicationController::processMeshDivision(IUserInterface* ui)
+void ApplicationController::initializeVtkProcessor(const ProcessRequest& request)
 {
-    if (!ui) return false;
-    
-    auto dividedMeshes = fileProcessor->processMeshDivision();
+    processingPipeline->setLoadCaseFiles(request.loadCaseFiles);
+    if (!processingPipeline->initializeVtkProcessor(request.vtkFile, request.stlFile, request.thresholds)) {
+        throw std::runtime_error("Failed to initialize VTK processor");
+    }
+}
+
+void ApplicationController::processMeshDivision()
+{
+    auto dividedMeshes = processingPipeline->processMeshDivision();
     if (dividedMeshes.empty()) {
-        emit showCriticalMessage("Error", "No meshes generated during division");
-        return false;
+        throw std::runtime_error("No meshes generated during division");
     }
-    
-    fileProcessor->getVtkProcessor()->saveDividedMeshes(dividedMeshes);
-    return true;
 }
 
-bool ApplicationController::process3mfGeneration(IUserInterface* ui)
+void ApplicationController::process3mfGeneration(const ProcessRequest& request)
 {
-    if (!ui) return false;
-    
-    auto mappings = getStressDensityMappings(ui);
-    auto currentMode = getCurrentMode(ui);
-    double maxStress = fileProcessor->getMaxStress();
-    
-    if (!fileProcessor->process3mfFile(currentMode.toStdString(), mappings, maxStress, nullptr)) {
-        emit showCriticalMessage("Error", "Failed to process 3MF file");
-        return false;
+    // processingPipeline はバックグラウンドの準備が読み込み直している可能性があるため、
+    // 分割結果とともに（ロック中に）引き継いだ最大応力を使う
+    const double maxStress = fileProcessor->getDivisionMaxStress();
+    if (!fileProcessor->process3mfFile(request.mode, request.mappings, maxStress)) {
+        throw std::runtime_error("Failed to process 3MF file");
     }
-    return true;
 }
 
-void ApplicationController::loadAndDisplayTempStlFiles(IUserInterface* ui)
+void ApplicationController::loadAndDisplayDividedMeshes(IUserInterface* ui)
+{
+    displayDividedMeshes(fileProcessor->getDividedMeshes(), ui);
+}
+
+void ApplicationController::displayDividedMeshes(const std::vector<DividedMesh>& meshes, IUserInterface* ui)
 {
     if (!ui || !fileProcessor->getVtkProcessor()) return;
     
@@ -202,14 +524,35 @@ void ApplicationController::loadAndDisplayTempStlFiles(IUserInterface* ui)
     }
     // --- ここまで追加 ---
     if (visualizationManager) {
-        visualizationManager->showTempDividedStl(fileProcessor->getVtkProcessor().get(), nullptr);
+        visualizationManager->showDividedMeshes(meshes, fileProcessor->getVtkProcessor().get(), nullptr);
     }
 }
 
-void ApplicationController::cleanupTempFiles()
+void ApplicationController::restoreVtkDisplay()
 {
-    std::filesystem::path tempFiledir = TempPathUtility::getTempSubDirPath("div");
-    FileUtility::clearDirectoryContents(tempFiledir);
+    // 粗いプレビューを取り除き、VTUの表示に戻す
+    if (visualizationManager) {
+        visualizationManager->removeDividedStlActors();
+        visualizationManager->setObjectVisible(vtkFile, true);
+    }
+    emit vtkVisibilityChanged(true);
+}
+
+void ApplicationController::setBandPreviewEnabled(bool enabled, IUserInterface* ui)
+{
+    bandPreviewEnabled = enabled;
+    if (enabled) {
+        updateBandPreview(ui);
+    } else if (visualizationManager) {
+        visualizationManager->hideBandPreview(fileProcessor->getVtkProcessor().get());
+    }
+}
+
+void ApplicationController::updateBandPreview(IUserInterface* ui)
+{
+    // 表示用の VtkProcessor はワーカースレッドから使われないため、処理中も更新できる
+    if (!bandPreviewEnabled || !ui || !visualizationManager) return;
+    visualizationManager->showBandPreview(fileProcessor->getVtkProcessor().get(), getStressThresholds(ui));
 }
 
 void ApplicationController::showSuccessMessage(IUserInterface* ui)
@@ -228,7 +571,11 @@ void ApplicationController::handleProcessingError(const std::exception& e, IUser
 bool ApplicationController::export3mfFile(IUserInterface* ui)
 {
     if (!ui) return false;
-    return exportManager->export3mfFile(stlFile, nullptr);
+    if (isProcessing()) {
+        emit showWarningMessage("Warning", "Cannot export while processing");
+        return false;
+    }
+    return exportManager->export3mfFile(resultWorkspace.get(), stlFile, nullptr);
 }
 
 std::vector<double> ApplicationController::getStressThresholds(IUserInterface* ui)
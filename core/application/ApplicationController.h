@@ -1,9 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <QString>
 #include <QObject>
+#include <QThread>
+#include <QTimer>
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
 #include "../processing/ProcessPipeline.h"
@@ -11,33 +14,60 @@
 #include "../export/ExportManager.h"
 #include "../interfaces/IUserInterface.h"
 
+class ProcessControl;
+class Workspace;
+
+// GUIスレッドで収集した処理パラメータ（ワーカースレッドに値渡しする）
+struct ProcessRequest {
+    std::string vtkFile;
+    std::vector<std::string> loadCaseFiles;
+    std::string stlFile;
+    std::vector<double> thresholds;
+    std::vector<StressDensityMapping> mappings;
+    std::string mode;
+    // 完了済みの投機的な分割結果を引き継いだ場合は true（読み込みと分割を省略する）
+    bool divisionReady = false;
+};
+
 class ApplicationController : public QObject {
     Q_OBJECT
 public:
     static constexpr int DIVIDED_MESH_COUNT = 4;
     ApplicationController(QObject* parent = nullptr);
-    ~ApplicationController() = default;
+    ~ApplicationController();
     
     // 初期化
     void initializeVisualizationManager(IUserInterface* ui);
 
     // ファイル操作
-    bool openVtkFile(const std::string& vtkFile, IUserInterface* ui);
+    // loadCaseFiles に同じメッシュの別の荷重ケースを指定すると、全ケースの包絡値（最大値）を表示・分割する
+    bool openVtkFile(const std::string& vtkFile, IUserInterface* ui,
+                     const std::vector<std::string>& loadCaseFiles = {});
     bool openStlFile(const std::string& stlFile, IUserInterface* ui);
     
-    // メイン処理
+    // メイン処理（ワーカースレッドで非同期に実行し、完了時に processingFinished を通知）
     bool processFiles(IUserInterface* ui);
+    void cancelProcessing();
+    bool isProcessing() const { return workerThread != nullptr; }
+
+    // しきい値が一定時間変化しなければ、バックグラウンドで分割を先行実行する
+    // しきい値が変わると実行中・完了済みの結果は破棄される
+    void scheduleSpeculativeDivision(IUserInterface* ui);
     
     // エクスポート
     bool export3mfFile(IUserInterface* ui);
     
     // 可視化
-    void loadAndDisplayTempStlFiles(IUserInterface* ui);
+    void loadAndDisplayDividedMeshes(IUserInterface* ui);
+    // スライダーのしきい値で区切った段階色をVTUに表示する（メッシュは分割しない）
+    void setBandPreviewEnabled(bool enabled, IUserInterface* ui);
+    void updateBandPreview(IUserInterface* ui);
     
     // 状態管理
     void setVtkFile(const std::string& vtkFile) { this->vtkFile = vtkFile; }
     void setStlFile(const std::string& stlFile) { this->stlFile = stlFile; }
     std::string getVtkFile() const { return vtkFile; }
+    const std::vector<std::string>& getLoadCaseFiles() const { return loadCaseFiles; }
     std::string getStlFile() const { return stlFile; }
     QString getCurrentStlFilename() const { return currentStlFilename; }
     void setCurrentStlFilename(const QString& filename) { currentStlFilename = filename; }
@@ -49,6 +79,7 @@ public:
 
 private:
     std::string vtkFile;
+    std::vector<std::string> loadCaseFiles;
     std::string stlFile;
     QString currentStlFilename;
     
@@ -56,6 +87,43 @@ private:
     std::unique_ptr<VisualizationManager> visualizationManager;
     std::unique_ptr<ExportManager> exportManager;
     
+    // 非同期処理の状態（GUIスレッドからのみ操作する）
+    enum class ProcessStatus { Succeeded, Cancelled, Failed };
+    QThread* workerThread = nullptr;
+    std::shared_ptr<ProcessControl> processControl;
+    IUserInterface* processingUi = nullptr;
+    // 最後に成功した処理の作業領域（エクスポート元）
+    std::shared_ptr<Workspace> resultWorkspace;
+    bool bandPreviewEnabled = false;
+
+    // VTUの読み込みとメッシュ分割を行うパイプライン
+    // 表示用の fileProcessor とは分け、読み込み済みデータと区間インデックスを
+    // バックグラウンドの準備・投機的な分割・本処理の間で再利用する
+    std::shared_ptr<ProcessPipeline> processingPipeline;
+    // processingPipeline を使うスレッドはこのロックを保持する（本処理は準備の完了をここで待つ）
+    std::mutex processingPipelineMutex;
+
+    // バックグラウンド処理の状態（GUIスレッドからのみ操作する、同時に実行するのは1つのみ）
+    enum class BackgroundTask { Preparation, SpeculativeDivision };
+    QThread* backgroundThread = nullptr;
+    BackgroundTask backgroundTask = BackgroundTask::Preparation;
+    std::shared_ptr<ProcessControl> backgroundControl;
+    // 実行中のタスクの終了後に準備を開始する
+    bool preparationPending = false;
+
+    // このセル数以上のVTUでは、外表面のみを分割した粗いプレビューを先に表示する
+    static constexpr vtkIdType PROGRESSIVE_MIN_CELLS = 2000000;
+    // 本処理中に粗いプレビューを表示したか（失敗・キャンセル時に元の表示へ戻すため）
+    bool previewDisplayed = false;
+
+    // 投機的な分割の状態
+    static constexpr int SPECULATION_DELAY_MS = 500;
+    QTimer speculationTimer;
+    IUserInterface* speculationUi = nullptr;
+    // 完了した分割結果の入力（speculativeReady の場合のみ有効）
+    ProcessRequest speculativeRequest;
+    bool speculativeReady = false;
+    
     // ヘルパーメソッド
     bool validateFiles(IUserInterface* ui);
     std::vector<double> getStressThresholds(IUserInterface* ui);
@@ -63,13 +131,26 @@ private:
     QString getCurrentMode(IUserInterface* ui);
     
     // ファイル処理のヘルパーメソッド
-    bool initializeVtkProcessor(IUserInterface* ui);
-    bool processMeshDivision(IUserInterface* ui);
-    bool process3mfGeneration(IUserInterface* ui);
-    void cleanupTempFiles();
+    // ワーカースレッドで実行する処理（失敗時は例外を送出）
+    void runPipeline(std::shared_ptr<ProcessControl> control, ProcessRequest request);
+    void divideOnProcessingPipeline(ProcessControl* control, const ProcessRequest& request);
+    void initializeVtkProcessor(const ProcessRequest& request);
+    void processMeshDivision();
+    void process3mfGeneration(const ProcessRequest& request);
+    void handleWorkerFinished(int status, const QString& message);
+    void reportProfile();
     void showSuccessMessage(IUserInterface* ui);
     void handleProcessingError(const std::exception& e, IUserInterface* ui);
     void resetDividedMeshWidgets(IUserInterface* ui);
+    void displayDividedMeshes(const std::vector<DividedMesh>& meshes, IUserInterface* ui);
+    void restoreVtkDisplay();
+    void startPreparation();
+    void startSpeculativeDivision();
+    void discardSpeculativeDivision();
+    void startBackgroundTask(BackgroundTask task, const ProcessRequest& request);
+    void handleBackgroundTaskFinished(BackgroundTask task, std::shared_ptr<ProcessControl> control,
+                                      const ProcessRequest& request, bool succeeded);
+    bool adoptSpeculativeDivision(const ProcessRequest& request);
 
 signals:
     // ファイル名設定シグナル
@@ -90,6 +171,12 @@ signals:
     // ストレス範囲設定シグナル
     void stressRangeChanged(double minStress, double maxStress);
     
+    // 処理の進捗・完了シグナル（GUIスレッドで受信する）
+    void processingProgress(const QString& stage, int percent);
+    void processingFinished(bool success, bool cancelled);
+    void processingReport(const QString& report);
+    void workerFinished(int status, const QString& message);
+    
     // メッセージ表示シグナル
     void showWarningMessage(const QString& title, const QString& message);
     void showCriticalMessage(const QString& title, const QString& message);
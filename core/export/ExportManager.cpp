@@ -1,5 +1,5 @@
 #include "ExportManager.h"
-#include "../../utils/tempPathUtility.h"
+#include "../processing/Workspace.h"
 
 const QString ExportManager::FILE_FILTER = "3MF Files (*.3mf)";
 
@@ -7,9 +7,8 @@ ExportManager::ExportManager() = default;
 
 ExportManager::~ExportManager() = default;
 
-bool ExportManager::export3mfFile(const std::string& stlFile, QWidget* parent) {
-    QString sourcePath = TempPathUtility::getTempFilePath("result/result.3mf");
-    if (!check3mfFileExists(sourcePath)) {
+bool ExportManager::export3mfFile(const Workspace* workspace, const std::string& stlFile, QWidget* parent) {
+    if (!check3mfFileExists(workspace)) {
         if (parent) {
             QMessageBox::warning(parent, "Error", "No 3MF file found in result directory.");
         }
@@ -40,7 +39,7 @@ bool ExportManager::export3mfFile(const std::string& stlFile, QWidget* parent) {
         }
     }
     
-    if (QFile::copy(sourcePath, savePath)) {
+    if (workspace->exportFile(Workspace::RESULT_3MF_PATH, savePath.toStdString())) {
         if (parent) {
             QMessageBox::information(parent, "Success", "3MF file exported successfully.");
         }
@@ -53,8 +52,8 @@ bool ExportManager::export3mfFile(const std::string& stlFile, QWidget* parent) {
     }
 }
 
-bool ExportManager::check3mfFileExists(const QString& sourcePath) const {
-    return QFile::exists(sourcePath);
+bool ExportManager::check3mfFileExists(const Workspace* workspace) const {
+    return workspace && workspace->hasFile(Workspace::RESULT_3MF_PATH);
 }
 
 QString ExportManager::generateDefaultFileName(const std::string& stlFile) const {
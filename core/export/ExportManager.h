@@ -7,18 +7,20 @@
 #include <QFileInfo>
 #include <string>
 
+class Workspace;
+
 class ExportManager {
 public:
     ExportManager();
     ~ExportManager();
 
-    // 3MFファイルのエクスポート
-    bool export3mfFile(const std::string& stlFile, QWidget* parent = nullptr);
+    // 3MFファイルのエクスポート（workspace に保存された処理結果を書き出す）
+    bool export3mfFile(const Workspace* workspace, const std::string& stlFile, QWidget* parent = nullptr);
 
 private:
     static const QString FILE_FILTER;
     
     // ヘルパーメソッド
-    bool check3mfFileExists(const QString& sourcePath) const;
+    bool check3mfFileExists(const Workspace* workspace) const;
     QString generateDefaultFileName(const std::string& stlFile) const;
 }; 
\ No newline at end of file
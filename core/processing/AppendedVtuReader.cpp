@@ -0,0 +1,429 @@
+#include "AppendedVtuReader.h"
+#include "MappedDataArray.h"
+#include "ProcessControl.h"
+#include "../../utils/parallelUtility.h"
+#include "../../utils/profiler.h"
+#include <QByteArray>
+#include <QLatin1String>
+#include <QXmlStreamReader>
+#include <vtkCellArray.h>
+#include <vtkLZ4DataCompressor.h>
+#include <vtkLZMADataCompressor.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkZLibDataCompressor.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace {
+// ヘッダー（XML部分）を探す範囲。appended 形式でないファイルの全体を走査しないよう制限する
+constexpr size_t MAX_HEADER_BYTES = 16 * 1024 * 1024;
+// 展開の進捗を通知する間隔（ブロック数）
+constexpr size_t PROGRESS_INTERVAL_BLOCKS = 256;
+
+int parseValueType(QStringView name)
+{
+    static const std::pair<const char*, int> TYPES[] = {
+        {"Int8", VTK_TYPE_INT8}, {"UInt8", VTK_TYPE_UINT8},
+        {"Int16", VTK_TYPE_INT16}, {"UInt16", VTK_TYPE_UINT16},
+        {"Int32", VTK_TYPE_INT32}, {"UInt32", VTK_TYPE_UINT32},
+        {"Int64", VTK_TYPE_INT64}, {"UInt64", VTK_TYPE_UINT64},
+        {"Float32", VTK_TYPE_FLOAT32}, {"Float64", VTK_TYPE_FLOAT64}};
+    for (const auto& type : TYPES) {
+        if (name == QLatin1String(type.first)) {
+            return type.second;
+        }
+    }
+    return 0;
+}
+
+bool isLittleEndianHost()
+{
+    const std::uint16_t value = 1;
+    std::uint8_t firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
+
+bool isFloatType(int type)
+{
+    return type == VTK_TYPE_FLOAT32 || type == VTK_TYPE_FLOAT64;
+}
+} // namespace
+
+bool AppendedVtuReader::open(const std::string& path)
+{
+    *this = AppendedVtuReader();
+    file = MappedFile::open(path);
+    if (!file) {
+        return false;
+    }
+
+    // XML部分は <AppendedData ...> の直後の '_' までで、以降はバイナリデータ
+    const char* begin = reinterpret_cast<const char*>(file->data());
+    const std::string_view header(begin, std::min(file->size(), MAX_HEADER_BYTES));
+    const size_t tagStart = header.find("<AppendedData");
+    const size_t tagEnd = tagStart == std::string_view::npos ? tagStart : header.find('>', tagStart);
+    if (tagEnd == std::string_view::npos) {
+        file.reset();
+        return false;
+    }
+    size_t marker = tagEnd + 1;
+    while (marker < file->size() && std::isspace(static_cast<unsigned char>(begin[marker]))) {
+        ++marker;
+    }
+    if (marker >= file->size() || begin[marker] != '_') {
+        file.reset();
+        return false;
+    }
+    dataStart = marker + 1;
+
+    // 終了タグを補って、ヘッダーだけを1つのXML文書として解析する
+    QByteArray xml(begin, static_cast<qsizetype>(tagEnd + 1));
+    xml.append("</AppendedData></VTKFile>");
+    QXmlStreamReader reader(xml);
+    QString section;
+    int pieceCount = 0;
+    bool rawEncoding = false;
+    bool supported = true;
+    while (supported && !reader.atEnd()) {
+        reader.readNext();
+        if (reader.isEndElement()) {
+            if (reader.name() == section) {
+                section.clear();
+            }
+            continue;
+        }
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        const QStringView name = reader.name();
+        const QXmlStreamAttributes attributes = reader.attributes();
+        if (name == QLatin1String("VTKFile")) {
+            headerType = attributes.hasAttribute("header_type")
+                ? parseValueType(attributes.value("header_type")) : VTK_TYPE_UINT32;
+            const QStringView compressorName = attributes.value("compressor");
+            if (compressorName.isEmpty()) compressor = Compressor::None;
+            else if (compressorName == QLatin1String("vtkZLibDataCompressor")) compressor = Compressor::ZLib;
+            else if (compressorName == QLatin1String("vtkLZ4DataCompressor")) compressor = Compressor::LZ4;
+            else if (compressorName == QLatin1String("vtkLZMADataCompressor")) compressor = Compressor::LZMA;
+            else supported = false;
+            supported = supported && attributes.value("type") == QLatin1String("UnstructuredGrid")
+                && attributes.value("byte_order") == QLatin1String(isLittleEndianHost() ? "LittleEndian" : "BigEndian")
+                && (headerType == VTK_TYPE_UINT32 || headerType == VTK_TYPE_UINT64);
+        } else if (name == QLatin1String("Piece")) {
+            ++pieceCount;
+            pointCount = attributes.value("NumberOfPoints").toULongLong();
+            cellCount = attributes.value("NumberOfCells").toULongLong();
+        } else if (name == QLatin1String("PointData") || name == QLatin1String("CellData")
+                   || name == QLatin1String("Points") || name == QLatin1String("Cells")
+                   || name == QLatin1String("FieldData")) {
+            section = name.toString();
+        } else if (name == QLatin1String("DataArray")) {
+            ArrayInfo info;
+            info.name = attributes.value("Name").toString().toStdString();
+            info.type = parseValueType(attributes.value("type"));
+            info.components = attributes.hasAttribute("NumberOfComponents")
+                ? attributes.value("NumberOfComponents").toInt() : 1;
+            info.appended = attributes.value("format") == QLatin1String("appended");
+            info.offset = attributes.value("offset").toULongLong();
+            if (section == QLatin1String("Points")) {
+                points = info;
+            } else if (section == QLatin1String("Cells")) {
+                if (info.name == "connectivity") connectivity = info;
+                else if (info.name == "offsets") offsets = info;
+                else if (info.name == "types") types = info;
+                // 多面体セルの面情報には対応しない
+                else if (info.name == "faces" || info.name == "faceoffsets") supported = false;
+            } else if (section == QLatin1String("PointData")) {
+                pointArrays.push_back(info);
+                pointArrayNames.push_back(info.name);
+            }
+        } else if (name == QLatin1String("AppendedData")) {
+            rawEncoding = attributes.value("encoding") == QLatin1String("raw");
+        }
+    }
+
+    supported = supported && !reader.hasError() && pieceCount == 1 && rawEncoding && pointCount > 0
+        && points.appended && isFloatType(points.type) && points.components == 3
+        && connectivity.appended && offsets.appended && types.appended
+        && connectivity.type == offsets.type
+        && (offsets.type == VTK_TYPE_INT32 || offsets.type == VTK_TYPE_INT64)
+        && types.type == VTK_TYPE_UINT8;
+    if (!supported) {
+        *this = AppendedVtuReader();
+        return false;
+    }
+    return true;
+}
+
+bool AppendedVtuReader::readHeaderWord(std::uint64_t position, std::uint64_t& value) const
+{
+    const std::uint64_t wordSize = headerType == VTK_TYPE_UINT64 ? 8 : 4;
+    if (position > file->size() || wordSize > file->size() - position) {
+        return false;
+    }
+    if (wordSize == 8) {
+        std::memcpy(&value, file->data() + position, 8);
+    } else {
+        std::uint32_t value32 = 0;
+        std::memcpy(&value32, file->data() + position, 4);
+        value = value32;
+    }
+    return true;
+}
+
+bool AppendedVtuReader::getArrayBytes(const ArrayInfo& info, std::uint64_t& bytes) const
+{
+    const std::uint64_t position = dataStart + info.offset;
+    if (compressor == Compressor::None) {
+        return readHeaderWord(position, bytes);
+    }
+    // 圧縮ヘッダー: [ブロック数][ブロックサイズ][最後のブロックのサイズ][各ブロックの圧縮後サイズ...]
+    const std::uint64_t wordSize = headerType == VTK_TYPE_UINT64 ? 8 : 4;
+    std::uint64_t blockCount = 0;
+    std::uint64_t blockSize = 0;
+    std::uint64_t lastBlockSize = 0;
+    if (!readHeaderWord(position, blockCount) || !readHeaderWord(position + wordSize, blockSize)
+        || !readHeaderWord(position + 2 * wordSize, lastBlockSize)) {
+        return false;
+    }
+    bytes = blockCount == 0 ? 0 : (blockCount - 1) * blockSize + (lastBlockSize != 0 ? lastBlockSize : blockSize);
+    return true;
+}
+
+std::uint8_t* AppendedVtuReader::getBlockData(const ArrayInfo& info, std::uint64_t tuples) const
+{
+    const std::uint64_t headerSize = headerType == VTK_TYPE_UINT64 ? 8 : 4;
+    const std::uint64_t position = dataStart + info.offset;
+    std::uint64_t blockBytes = 0;
+    if (!readHeaderWord(position, blockBytes)) {
+        return nullptr;
+    }
+    const std::uint64_t expectedBytes = tuples * static_cast<std::uint64_t>(info.components)
+        * static_cast<std::uint64_t>(vtkDataArray::GetDataTypeSize(info.type));
+    if (blockBytes != expectedBytes || blockBytes > file->size() - position - headerSize) {
+        return nullptr;
+    }
+    return file->data() + position + headerSize;
+}
+
+bool AppendedVtuReader::addBlockTasks(const ArrayInfo& info, std::uint8_t* destination, std::uint64_t bytes,
+                                      std::vector<BlockTask>& tasks) const
+{
+    const std::uint64_t wordSize = headerType == VTK_TYPE_UINT64 ? 8 : 4;
+    const std::uint64_t position = dataStart + info.offset;
+    std::uint64_t blockCount = 0;
+    std::uint64_t blockSize = 0;
+    std::uint64_t uncompressedBytes = 0;
+    if (!readHeaderWord(position, blockCount) || !readHeaderWord(position + wordSize, blockSize)
+        || !getArrayBytes(info, uncompressedBytes) || uncompressedBytes != bytes
+        || blockCount > (file->size() - position) / wordSize) {
+        return false;
+    }
+
+    std::uint64_t source = position + (3 + blockCount) * wordSize;
+    std::uint64_t written = 0;
+    for (std::uint64_t block = 0; block < blockCount; ++block) {
+        std::uint64_t compressedSize = 0;
+        if (!readHeaderWord(position + (3 + block) * wordSize, compressedSize)
+            || source > file->size() || compressedSize > file->size() - source) {
+            return false;
+        }
+        BlockTask task;
+        task.source = file->data() + source;
+        task.sourceSize = static_cast<size_t>(compressedSize);
+        task.destination = destination + written;
+        task.destinationSize = static_cast<size_t>(std::min(blockSize, bytes - written));
+        tasks.push_back(task);
+        source += compressedSize;
+        written += task.destinationSize;
+    }
+    return written == bytes;
+}
+
+bool AppendedVtuReader::decompress(const std::vector<BlockTask>& tasks, ProcessControl* control) const
+{
+    if (tasks.empty()) {
+        return true;
+    }
+    Profiler::Scope profile("Decompress VTU blocks");
+    profile.addCount("blocks", static_cast<std::int64_t>(tasks.size()));
+
+    // ブロックの大きさはほぼ等しいため、ワーカーごとに1つの展開器を作り、ブロックを順番に割り当てる
+    const size_t workerCount = std::min<size_t>(std::max(1u, ParallelUtility::getWorkerCount()), tasks.size());
+    std::atomic<bool> failed{false};
+    std::atomic<size_t> completed{0};
+    ParallelUtility::parallelFor(workerCount, static_cast<unsigned int>(workerCount), [&](size_t worker) {
+        vtkSmartPointer<vtkDataCompressor> decompressor;
+        switch (compressor) {
+        case Compressor::ZLib: decompressor = vtkSmartPointer<vtkZLibDataCompressor>::New(); break;
+        case Compressor::LZ4: decompressor = vtkSmartPointer<vtkLZ4DataCompressor>::New(); break;
+        case Compressor::LZMA: decompressor = vtkSmartPointer<vtkLZMADataCompressor>::New(); break;
+        case Compressor::None: return;
+        }
+        for (size_t i = worker; i < tasks.size(); i += workerCount) {
+            if (failed.load() || (control && control->isCancelled())) {
+                return;
+            }
+            const BlockTask& task = tasks[i];
+            const size_t size = decompressor->Uncompress(task.source, task.sourceSize,
+                                                         task.destination, task.destinationSize);
+            if (size != task.destinationSize) {
+                failed.store(true);
+                return;
+            }
+            const size_t done = ++completed;
+            if (control && done % PROGRESS_INTERVAL_BLOCKS == 0) {
+                control->reportProgress(static_cast<double>(done) / static_cast<double>(tasks.size()));
+            }
+        }
+    });
+    if (failed.load()) {
+        std::cerr << "Warning: Failed to decompress VTU data block" << std::endl;
+        return false;
+    }
+    return !(control && control->isCancelled());
+}
+
+vtkSmartPointer<vtkDataArray> AppendedVtuReader::loadArray(const ArrayInfo& info, std::uint64_t tuples,
+                                                           std::vector<BlockTask>& tasks) const
+{
+    vtkSmartPointer<vtkDataArray> array;
+    if (compressor == Compressor::None) {
+        std::uint8_t* data = getBlockData(info, tuples);
+        if (!data) {
+            return nullptr;
+        }
+        // 元ファイルは他のプログラムに上書きされうるため、マップを参照し続けずにコピーする
+        array = MappedDataArray::copy(data, info.type, info.components, static_cast<vtkIdType>(tuples));
+    } else {
+        // 展開先の配列を確保し、ブロックは後でまとめて並列に展開する
+        array = MappedDataArray::create(info.type);
+        if (!array) {
+            return nullptr;
+        }
+        array->SetNumberOfComponents(info.components);
+        array->SetNumberOfTuples(static_cast<vtkIdType>(tuples));
+        const std::uint64_t bytes = tuples * static_cast<std::uint64_t>(info.components)
+            * static_cast<std::uint64_t>(array->GetDataTypeSize());
+        if (!addBlockTasks(info, static_cast<std::uint8_t*>(array->GetVoidPointer(0)), bytes, tasks)) {
+            return nullptr;
+        }
+    }
+    if (array) {
+        array->SetName(info.name.c_str());
+    }
+    return array;
+}
+
+vtkSmartPointer<vtkDataArray> AppendedVtuReader::loadOffsets(std::vector<BlockTask>& tasks) const
+{
+    // VTUのオフセットは各セルの終端のみで、vtkCellArray には先頭の0を加えたセル数+1個が必要
+    const int valueSize = vtkDataArray::GetDataTypeSize(offsets.type);
+    if (compressor == Compressor::None) {
+        std::uint8_t* data = getBlockData(offsets, cellCount);
+        if (!data) {
+            return nullptr;
+        }
+        vtkSmartPointer<vtkDataArray> array = MappedDataArray::create(offsets.type);
+        array->SetNumberOfTuples(static_cast<vtkIdType>(cellCount + 1));
+        std::uint8_t* values = static_cast<std::uint8_t*>(array->GetVoidPointer(0));
+        std::memset(values, 0, static_cast<size_t>(valueSize));
+        std::memcpy(values + valueSize, data, static_cast<size_t>(cellCount) * valueSize);
+        return array;
+    }
+
+    vtkSmartPointer<vtkDataArray> array = MappedDataArray::create(offsets.type);
+    array->SetNumberOfTuples(static_cast<vtkIdType>(cellCount + 1));
+    std::uint8_t* values = static_cast<std::uint8_t*>(array->GetVoidPointer(0));
+    std::memset(values, 0, static_cast<size_t>(valueSize));
+    if (!addBlockTasks(offsets, values + valueSize, cellCount * static_cast<std::uint64_t>(valueSize), tasks)) {
+        return nullptr;
+    }
+    return array;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> AppendedVtuReader::read(const std::vector<std::string>& pointArrayNames,
+                                                             ProcessControl* control)
+{
+    if (!file) {
+        return nullptr;
+    }
+    Profiler::Scope profile("Read appended VTU");
+    profile.addCount("bytes", static_cast<std::int64_t>(file->size()));
+
+    std::vector<const ArrayInfo*> selectedArrays;
+    for (const auto& pointArrayName : pointArrayNames) {
+        const ArrayInfo* pointArray = nullptr;
+        for (const auto& info : pointArrays) {
+            if (info.name == pointArrayName) {
+                pointArray = &info;
+            }
+        }
+        if (!pointArray || !pointArray->appended || pointArray->type == 0 || pointArray->components < 1) {
+            return nullptr;
+        }
+        selectedArrays.push_back(pointArray);
+    }
+
+    // 接続の総数は配列のバイト数から求める（オフセットの展開を待たずに全配列を並列に展開するため）
+    std::uint64_t connectivityBytes = 0;
+    const std::uint64_t connectivityValueSize = static_cast<std::uint64_t>(vtkDataArray::GetDataTypeSize(connectivity.type));
+    if (!getArrayBytes(connectivity, connectivityBytes) || connectivityBytes % connectivityValueSize != 0) {
+        std::cerr << "Warning: Inconsistent appended data blocks, falling back to the XML reader" << std::endl;
+        return nullptr;
+    }
+
+    std::vector<BlockTask> tasks;
+    vtkSmartPointer<vtkDataArray> pointData = loadArray(points, pointCount, tasks);
+    vtkSmartPointer<vtkDataArray> offsetData = loadOffsets(tasks);
+    vtkSmartPointer<vtkDataArray> connectivityData = loadArray(connectivity, connectivityBytes / connectivityValueSize, tasks);
+    vtkSmartPointer<vtkDataArray> cellTypes = loadArray(types, cellCount, tasks);
+    std::vector<vtkSmartPointer<vtkDataArray>> selectedData;
+    for (const ArrayInfo* pointArray : selectedArrays) {
+        selectedData.push_back(loadArray(*pointArray, pointCount, tasks));
+    }
+    const bool selectedLoaded = std::all_of(selectedData.begin(), selectedData.end(),
+                                            [](const vtkSmartPointer<vtkDataArray>& array) { return array != nullptr; });
+    if (!pointData || !offsetData || !connectivityData || !cellTypes || !selectedLoaded) {
+        std::cerr << "Warning: Inconsistent appended data blocks, falling back to the XML reader" << std::endl;
+        return nullptr;
+    }
+    if (!decompress(tasks, control)) {
+        return nullptr;
+    }
+
+    vtkNew<vtkPoints> gridPoints;
+    gridPoints->SetData(pointData);
+    vtkNew<vtkCellArray> cells;
+    if (offsets.type == VTK_TYPE_INT64) {
+        cells->SetData(vtkTypeInt64Array::SafeDownCast(offsetData), vtkTypeInt64Array::SafeDownCast(connectivityData));
+    } else {
+        cells->SetData(vtkTypeInt32Array::SafeDownCast(offsetData), vtkTypeInt32Array::SafeDownCast(connectivityData));
+    }
+
+    vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->SetPoints(gridPoints);
+    grid->SetCells(vtkUnsignedCharArray::SafeDownCast(cellTypes), cells);
+    for (const auto& array : selectedData) {
+        grid->GetPointData()->AddArray(array);
+    }
+
+    // データセットはマップを参照しないため、ここで解除してファイルを他のプログラムに明け渡す
+    file.reset();
+
+    profile.addCount("cells", grid->GetNumberOfCells());
+    profile.addCount("points", grid->GetNumberOfPoints());
+    std::cout << (isCompressed() ? "Decompressed" : "Copied") << " appended VTU data ("
+              << pointArrays.size() << " point arrays, using " << selectedArrays.size() << ")" << std::endl;
+    return grid;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include "../../utils/mappedFile.h"
+
+class ProcessControl;
+
+// appended 形式（<AppendedData encoding="raw">）のVTUを読み込むクラス
+// 読み込み中のみファイルをメモリにマップし、圧縮なしの配列はマップから配列へ一度だけコピーする
+// 圧縮された配列（zlib / lz4 / lzma）は、独立に圧縮されたブロックを並列に展開して配列に直接書き込む
+// 作成したデータセットは元ファイルを参照しないため、ソルバーが同じファイルを上書きしても影響を受けない
+//
+// 使い方は vtkXMLUnstructuredGridReader と同様で、open でヘッダーから配列名を取得した後、
+// 必要な点配列（応力のスカラー配列、またはテンソル・成分配列）を指定して read する
+class AppendedVtuReader {
+public:
+    // ファイルをマップしてヘッダーを解析する（対応する形式でなければ false）
+    bool open(const std::string& path);
+    const std::vector<std::string>& getPointArrayNames() const { return pointArrayNames; }
+    bool isCompressed() const { return compressor != Compressor::None; }
+    // 点・セルと指定した点配列のみを持つデータセットを作成する（読み込めない場合・キャンセル時は nullptr）
+    vtkSmartPointer<vtkUnstructuredGrid> read(const std::vector<std::string>& pointArrayNames,
+                                              ProcessControl* control = nullptr);
+
+private:
+    enum class Compressor { None, ZLib, LZ4, LZMA };
+
+    struct ArrayInfo {
+        std::string name;
+        int type = 0;
+        int components = 1;
+        std::uint64_t offset = 0;
+        bool appended = false;
+    };
+
+    // 圧縮されたブロック1つの展開先
+    struct BlockTask {
+        const std::uint8_t* source = nullptr;
+        size_t sourceSize = 0;
+        std::uint8_t* destination = nullptr;
+        size_t destinationSize = 0;
+    };
+
+    bool readHeaderWord(std::uint64_t position, std::uint64_t& value) const;
+    // 配列の値のバイト数（圧縮されている場合は展開後のバイト数）を取得する
+    bool getArrayBytes(const ArrayInfo& info, std::uint64_t& bytes) const;
+    // appended データのブロック（先頭にバイト数、続いて値）の値の位置を返す
+    std::uint8_t* getBlockData(const ArrayInfo& info, std::uint64_t tuples) const;
+    // 圧縮された配列のブロックを destination に展開するタスクを追加する
+    bool addBlockTasks(const ArrayInfo& info, std::uint8_t* destination, std::uint64_t bytes,
+                       std::vector<BlockTask>& tasks) const;
+    bool decompress(const std::vector<BlockTask>& tasks, ProcessControl* control) const;
+
+    vtkSmartPointer<vtkDataArray> loadArray(const ArrayInfo& info, std::uint64_t tuples,
+                                            std::vector<BlockTask>& tasks) const;
+    vtkSmartPointer<vtkDataArray> loadOffsets(std::vector<BlockTask>& tasks) const;
+
+    std::shared_ptr<MappedFile> file;
+    Compressor compressor = Compressor::None;
+    int headerType = 0;
+    std::uint64_t dataStart = 0;
+    std::uint64_t pointCount = 0;
+    std::uint64_t cellCount = 0;
+    ArrayInfo points;
+    ArrayInfo connectivity;
+    ArrayInfo offsets;
+    ArrayInfo types;
+    std::vector<ArrayInfo> pointArrays;
+    std::vector<std::string> pointArrayNames;
+};
@@ -0,0 +1,217 @@
+#include "DatasetCache.h"
+#include "ProcessControl.h"
+#include "../../utils/profiler.h"
+#include <vtkMultiBlockDataSet.h>
+#include <vtkSTLReader.h>
+#include <iostream>
+#include <system_error>
+
+namespace {
+std::string makeKey(const std::string& path, const std::string& variant)
+{
+    return path + "|" + variant;
+}
+
+// 他のスレッドと共有する前に範囲を求めておく（データセット内部の範囲のキャッシュもここで確定する）
+std::vector<DatasetCache::ScalarRange> computeScalarRanges(vtkDataObject* data)
+{
+    std::vector<DatasetCache::ScalarRange> ranges;
+    if (vtkMultiBlockDataSet* blocks = vtkMultiBlockDataSet::SafeDownCast(data)) {
+        for (unsigned int i = 0; i < blocks->GetNumberOfBlocks(); ++i) {
+            DatasetCache::ScalarRange range = {0.0, 0.0};
+            if (vtkDataSet* block = vtkDataSet::SafeDownCast(blocks->GetBlock(i))) {
+                block->GetScalarRange(range.data());
+            }
+            ranges.push_back(range);
+        }
+    } else if (vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data)) {
+        DatasetCache::ScalarRange range = {0.0, 0.0};
+        dataSet->GetScalarRange(range.data());
+        ranges.push_back(range);
+    }
+    return ranges;
+}
+}
+
+DatasetCache& DatasetCache::instance()
+{
+    static DatasetCache cache;
+    return cache;
+}
+
+void DatasetCache::eraseLoadLocked(const std::string& key, std::uint64_t loadId)
+{
+    auto it = entries.find(key);
+    if (it != entries.end() && it->second.loadId == loadId) {
+        entries.erase(it);
+    }
+}
+
+vtkSmartPointer<vtkDataObject> DatasetCache::getOrLoad(const std::string& path, const std::string& variant,
+                                                       const Loader& loader, std::vector<ScalarRange>* scalarRanges,
+                                                       ProcessControl* control)
+{
+    std::error_code ec;
+    const std::uintmax_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to access file: " << path << std::endl;
+        return nullptr;
+    }
+    const std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to access file: " << path << std::endl;
+        return nullptr;
+    }
+
+    const std::string key = makeKey(path, variant);
+    std::promise<Loaded> promise;
+    std::uint64_t loadId = 0;
+    for (;;) {
+        std::shared_future<Loaded> cached;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second.fileSize == fileSize && it->second.fileTime == fileTime) {
+                it->second.lastUsed = ++useCounter;
+                cached = it->second.data;
+            } else {
+                // 未登録またはファイルが更新されている場合は読み込み中のエントリとして登録する
+                Entry entry;
+                entry.path = path;
+                entry.fileSize = fileSize;
+                entry.fileTime = fileTime;
+                entry.data = promise.get_future().share();
+                entry.lastUsed = ++useCounter;
+                entry.loadId = loadId = ++loadCounter;
+                entries[key] = entry;
+            }
+        }
+        if (!cached.valid()) {
+            break;
+        }
+
+        // 他のスレッドが読み込み中の場合はロックの外で完了を待つ
+        std::cout << "Using cached dataset: " << path << std::endl;
+        const Loaded& loaded = cached.get();
+        if (!loaded.data && loaded.cancelled && !(control && control->isCancelled())) {
+            // 読み込んでいた側がキャンセルされただけなので、自身の loader で読み込み直す
+            // （失敗したエントリは結果の通知前に取り除かれている）
+            continue;
+        }
+        if (scalarRanges) {
+            *scalarRanges = loaded.scalarRanges;
+        }
+        return loaded.data;
+    }
+
+    Loaded loaded;
+    try {
+        loaded.data = loader();
+        loaded.scalarRanges = computeScalarRanges(loaded.data);
+    } catch (...) {
+        Loaded failed;
+        failed.cancelled = control && control->isCancelled();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            eraseLoadLocked(key, loadId);
+        }
+        promise.set_value(failed);
+        throw;
+    }
+
+    if (!loaded.data) {
+        loaded.cancelled = control && control->isCancelled();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            eraseLoadLocked(key, loadId);
+        }
+        promise.set_value(loaded);
+        return nullptr;
+    }
+    promise.set_value(loaded);
+    if (scalarRanges) {
+        *scalarRanges = loaded.scalarRanges;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    evictLocked();
+    return loaded.data;
+}
+
+vtkSmartPointer<vtkPolyData> DatasetCache::getPolyData(const std::string& path)
+{
+    vtkSmartPointer<vtkDataObject> data = getOrLoad(path, "stl", [&path]() -> vtkSmartPointer<vtkDataObject> {
+        Profiler::Scope profile("Read STL");
+        vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
+        reader->SetFileName(path.c_str());
+        reader->Update();
+        vtkSmartPointer<vtkPolyData> polyData = reader->GetOutput();
+        if (!polyData || polyData->GetNumberOfPoints() == 0) {
+            std::cerr << "Error: Unable to read the STL file." << std::endl;
+            return nullptr;
+        }
+        profile.addCount("triangles", polyData->GetNumberOfPolys());
+        return polyData;
+    });
+    return vtkPolyData::SafeDownCast(data);
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> DatasetCache::getUnstructuredGrid(
+    const std::string& path, const std::string& variant,
+    const std::function<vtkSmartPointer<vtkUnstructuredGrid>()>& loader, ScalarRange* scalarRange,
+    ProcessControl* control)
+{
+    std::vector<ScalarRange> ranges;
+    vtkSmartPointer<vtkDataObject> data = getOrLoad(path, "vtu:" + variant, [&loader]() -> vtkSmartPointer<vtkDataObject> {
+        return loader();
+    }, &ranges, control);
+    if (scalarRange && !ranges.empty()) {
+        *scalarRange = ranges.front();
+    }
+    return vtkUnstructuredGrid::SafeDownCast(data);
+}
+
+void DatasetCache::remove(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.path == path) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DatasetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+void DatasetCache::setMaxEntries(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxEntries = count;
+    evictLocked();
+}
+
+size_t DatasetCache::getEntryCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void DatasetCache::evictLocked()
+{
+    while (maxEntries > 0 && entries.size() > maxEntries) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        // 破棄しても、既に受け取ったインスタンスは参照カウントにより有効なまま
+        entries.erase(oldest);
+    }
+}
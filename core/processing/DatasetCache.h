@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkDataObject.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+class ProcessControl;
+
+// 読み込んだデータセットをプロセス全体で共有するキャッシュ
+// キーはファイルパス・サイズ・更新日時（と読み込み方法を表す variant）で、
+// 表示用と処理用の両方から同じインスタンスを受け取ることで同じファイルの再パースを避ける
+// 返すデータセットは共有されるため、受け取った側で内容を変更しないこと
+// （GetScalarRange なども内部のキャッシュを書き換えるため、範囲は登録時に求めたものを使う）
+class DatasetCache {
+public:
+    using Loader = std::function<vtkSmartPointer<vtkDataObject>()>;
+    using ScalarRange = std::array<double, 2>;
+
+    static DatasetCache& instance();
+
+    DatasetCache(const DatasetCache&) = delete;
+    DatasetCache& operator=(const DatasetCache&) = delete;
+
+    // キャッシュにあれば共有インスタンスを返し、なければ loader で読み込んで登録する
+    // 同じキーを複数スレッドが同時に要求した場合、読み込みは一度だけ行われる
+    // 読み込みに失敗した場合は nullptr を返し、キャッシュには登録しない
+    // scalarRanges にはアクティブスカラーの範囲を返す（マルチブロックの場合はブロックごと）
+    // control は loader が使う処理の制御で、先に読み込みを始めた側だけがキャンセルされた場合、
+    // 待っていた側はキャンセルされていなければ自身の loader で読み込み直す
+    vtkSmartPointer<vtkDataObject> getOrLoad(const std::string& path, const std::string& variant,
+                                             const Loader& loader, std::vector<ScalarRange>* scalarRanges = nullptr,
+                                             ProcessControl* control = nullptr);
+
+    // STLファイルを読み込む（vtkSTLReader）
+    vtkSmartPointer<vtkPolyData> getPolyData(const std::string& path);
+    // VTUファイルを読み込む（読み込み方法は loader に任せ、variant で区別する）
+    vtkSmartPointer<vtkUnstructuredGrid> getUnstructuredGrid(const std::string& path, const std::string& variant,
+                                                             const std::function<vtkSmartPointer<vtkUnstructuredGrid>()>& loader,
+                                                             ScalarRange* scalarRange = nullptr,
+                                                             ProcessControl* control = nullptr);
+
+    void remove(const std::string& path);
+    void clear();
+
+    // 保持するデータセット数の上限（超えた場合は最も長く使われていないものから破棄）
+    void setMaxEntries(size_t count);
+    size_t getEntryCount() const;
+
+private:
+    DatasetCache() = default;
+
+    // 読み込んだデータセットと、共有する前に求めたスカラーの範囲
+    struct Loaded {
+        vtkSmartPointer<vtkDataObject> data;
+        std::vector<ScalarRange> scalarRanges;
+        bool cancelled = false; // 読み込んだ側のキャンセルにより失敗したか
+    };
+
+    struct Entry {
+        std::string path; // variant に '|' を含む場合があるため、キーとは別に保持する
+        std::uintmax_t fileSize = 0;
+        std::filesystem::file_time_type fileTime;
+        std::shared_future<Loaded> data;
+        std::uint64_t lastUsed = 0;
+        std::uint64_t loadId = 0; // 登録した読み込みの識別子（失敗時に自身のエントリだけを取り除くため）
+    };
+
+    void evictLocked();
+    // key のエントリが loadId の読み込みで登録したものであれば取り除く
+    // （読み込み中にファイルが更新され、別の読み込みが登録し直した場合は残す）
+    void eraseLoadLocked(const std::string& key, std::uint64_t loadId);
+
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries; // キー: パス + "|" + variant
+    std::uint64_t useCounter = 0;
+    std::uint64_t loadCounter = 0;
+    size_t maxEntries = 4;
+};
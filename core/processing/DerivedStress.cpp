@@ -0,0 +1,368 @@
+#include "DerivedStress.h"
+#include "ProcessControl.h"
+#include "../../utils/parallelUtility.h"
+#include "../../utils/profiler.h"
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace {
+
+// 並列処理の単位（成分を連続した作業領域に集めてから計算する点数）
+constexpr vtkIdType CHUNK_SIZE = 2048;
+
+enum Component { XX, YY, ZZ, XY, YZ, XZ, ComponentCount };
+
+// 6成分テンソル（VTKの対称テンソルの順）と9成分テンソル（行優先）での各成分の位置
+constexpr int SYMMETRIC_TENSOR_COMPONENTS[ComponentCount] = {0, 1, 2, 3, 4, 5};
+constexpr int FULL_TENSOR_COMPONENTS[ComponentCount] = {0, 4, 8, 1, 5, 2};
+
+// 成分配列の名前の末尾と成分の対応
+const std::map<std::string, int>& componentSuffixes()
+{
+    static const std::map<std::string, int> suffixes = {
+        {"xx", XX}, {"yy", YY}, {"zz", ZZ}, {"xy", XY}, {"yx", XY}, {"yz", YZ}, {"zy", YZ}, {"xz", XZ}, {"zx", XZ},
+        {"11", XX}, {"22", YY}, {"33", ZZ}, {"12", XY}, {"21", XY}, {"23", YZ}, {"32", YZ}, {"13", XZ}, {"31", XZ}};
+    return suffixes;
+}
+
+std::string toLower(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// 名前を応力の接頭辞と成分に分ける（応力の成分配列でなければ false）
+bool splitComponentName(const std::string& name, std::string& prefix, int& component)
+{
+    if (name.size() < 3) {
+        return false;
+    }
+    const std::string lower = toLower(name);
+    auto it = componentSuffixes().find(lower.substr(lower.size() - 2));
+    if (it == componentSuffixes().end()) {
+        return false;
+    }
+    std::string stem = lower.substr(0, lower.size() - 2);
+    while (!stem.empty() && std::string(" _:-./").find(stem.back()) != std::string::npos) {
+        stem.pop_back();
+    }
+    // ひずみや変位の成分と区別するため、応力を表す接頭辞のみを対象にする
+    if (stem != "s" && stem != "sig" && stem != "sigma" && stem.find("stress") == std::string::npos) {
+        return false;
+    }
+    prefix = stem;
+    component = it->second;
+    return true;
+}
+
+std::string getDerivedLabel(DerivedStress::Quantity quantity)
+{
+    switch (quantity) {
+    case DerivedStress::Quantity::MaxPrincipal:
+        return "Max Principal Stress (derived)";
+    case DerivedStress::Quantity::Tresca:
+        return "Tresca Stress (derived)";
+    case DerivedStress::Quantity::SafetyFactor:
+        return "Safety Factor (derived)";
+    case DerivedStress::Quantity::Auto:
+    case DerivedStress::Quantity::VonMises:
+    default:
+        return "von Mises Stress (derived)";
+    }
+}
+
+// 成分の取り出し元（配列と成分番号）
+struct ComponentSource {
+    vtkDataArray* array = nullptr;
+    int component = 0;
+};
+
+template <typename T>
+void gatherValues(double* out, const T* values, int stride, vtkIdType count)
+{
+    for (vtkIdType i = 0; i < count; ++i) {
+        out[i] = static_cast<double>(values[i * stride]);
+    }
+}
+
+// [begin, begin + count) の点の成分を out に連続して並べる
+void gatherComponent(double* out, const ComponentSource& source, vtkIdType begin, vtkIdType count)
+{
+    const int stride = source.array->GetNumberOfComponents();
+    if (vtkFloatArray* values = vtkFloatArray::SafeDownCast(source.array)) {
+        gatherValues(out, values->GetPointer(begin * stride + source.component), stride, count);
+    } else if (vtkDoubleArray* values = vtkDoubleArray::SafeDownCast(source.array)) {
+        gatherValues(out, values->GetPointer(begin * stride + source.component), stride, count);
+    } else {
+        for (vtkIdType i = 0; i < count; ++i) {
+            out[i] = source.array->GetComponent(begin + i, source.component);
+        }
+    }
+}
+
+// 成分を連続した作業領域に集めた後、分岐のない要素ごとの演算で求める（コンパイラの自動ベクトル化が効く形）
+template <typename Out>
+void computeRange(Out* out, const double* const* s, vtkIdType count, DerivedStress::Quantity quantity,
+                  double yieldStrength, double maxSafetyFactor)
+{
+    const double* xx = s[XX];
+    const double* yy = s[YY];
+    const double* zz = s[ZZ];
+    const double* xy = s[XY];
+    const double* yz = s[YZ];
+    const double* xz = s[XZ];
+
+    if (quantity == DerivedStress::Quantity::Auto || quantity == DerivedStress::Quantity::VonMises
+        || quantity == DerivedStress::Quantity::SafetyFactor) {
+        const bool safetyFactor = quantity == DerivedStress::Quantity::SafetyFactor;
+        // 安全率を maxSafetyFactor で頭打ちにするため、応力の下限を 降伏応力 / maxSafetyFactor にする
+        const double minimumStress = yieldStrength / maxSafetyFactor;
+        for (vtkIdType i = 0; i < count; ++i) {
+            const double a = xx[i] - yy[i];
+            const double b = yy[i] - zz[i];
+            const double c = zz[i] - xx[i];
+            const double shear = xy[i] * xy[i] + yz[i] * yz[i] + xz[i] * xz[i];
+            const double vonMises = std::sqrt(0.5 * (a * a + b * b + c * c) + 3.0 * shear);
+            out[i] = static_cast<Out>(safetyFactor ? yieldStrength / std::max(vonMises, minimumStress) : vonMises);
+        }
+        return;
+    }
+
+    // 主応力は対称行列の固有値の三角関数による解法で求める
+    const bool tresca = quantity == DerivedStress::Quantity::Tresca;
+    const double twoThirdsPi = 2.0 * std::acos(-1.0) / 3.0;
+    for (vtkIdType i = 0; i < count; ++i) {
+        const double mean = (xx[i] + yy[i] + zz[i]) / 3.0;
+        const double dxx = xx[i] - mean;
+        const double dyy = yy[i] - mean;
+        const double dzz = zz[i] - mean;
+        const double shear = xy[i] * xy[i] + yz[i] * yz[i] + xz[i] * xz[i];
+        const double j2 = 0.5 * (dxx * dxx + dyy * dyy + dzz * dzz) + shear;
+        const double p = std::sqrt(j2 / 3.0);
+        const double j3 = dxx * (dyy * dzz - yz[i] * yz[i]) - xy[i] * (xy[i] * dzz - yz[i] * xz[i])
+                          + xz[i] * (xy[i] * yz[i] - dyy * xz[i]);
+        // 等方的な応力（p = 0）では r = 0 とし、3つの主応力を平均応力に一致させる
+        const double safeP = p > 0.0 ? p : 1.0;
+        const double r = p > 0.0 ? j3 / (2.0 * safeP * safeP * safeP) : 0.0;
+        const double phi = std::acos(std::min(1.0, std::max(-1.0, r))) / 3.0;
+        const double s1 = mean + 2.0 * p * std::cos(phi);
+        const double s3 = mean + 2.0 * p * std::cos(phi + twoThirdsPi);
+        out[i] = static_cast<Out>(tresca ? s1 - s3 : s1);
+    }
+}
+
+}
+
+std::string DerivedStress::Settings::getKey() const
+{
+    if (quantity == Quantity::Auto) {
+        return "";
+    }
+    std::ostringstream key;
+    key << getQuantityName(quantity);
+    if (quantity == Quantity::SafetyFactor) {
+        key.precision(17);
+        key << ":" << yieldStrength << ":" << maxSafetyFactor;
+    }
+    return key.str();
+}
+
+bool DerivedStress::parseQuantity(const std::string& name, Quantity& quantity)
+{
+    if (name == "auto") {
+        quantity = Quantity::Auto;
+    } else if (name == "vonMises") {
+        quantity = Quantity::VonMises;
+    } else if (name == "maxPrincipal") {
+        quantity = Quantity::MaxPrincipal;
+    } else if (name == "tresca") {
+        quantity = Quantity::Tresca;
+    } else if (name == "safetyFactor") {
+        quantity = Quantity::SafetyFactor;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string DerivedStress::getQuantityName(Quantity quantity)
+{
+    switch (quantity) {
+    case Quantity::VonMises:
+        return "vonMises";
+    case Quantity::MaxPrincipal:
+        return "maxPrincipal";
+    case Quantity::Tresca:
+        return "tresca";
+    case Quantity::SafetyFactor:
+        return "safetyFactor";
+    case Quantity::Auto:
+    default:
+        return "auto";
+    }
+}
+
+bool DerivedStress::isComponentArrayName(const std::string& name)
+{
+    std::string prefix;
+    int component = 0;
+    return splitComponentName(name, prefix, component);
+}
+
+std::vector<std::string> DerivedStress::findComponentArrays(const std::vector<std::string>& arrayNames)
+{
+    // 接頭辞ごとに成分を集め、最初に6成分がそろった組を使う
+    std::vector<std::string> prefixes;
+    std::map<std::string, std::array<std::string, ComponentCount>> groups;
+    for (const auto& name : arrayNames) {
+        std::string prefix;
+        int component = 0;
+        if (!splitComponentName(name, prefix, component)) {
+            continue;
+        }
+        if (groups.find(prefix) == groups.end()) {
+            prefixes.push_back(prefix);
+        }
+        std::string& slot = groups[prefix][component];
+        if (slot.empty()) {
+            slot = name;
+        }
+    }
+    for (const auto& prefix : prefixes) {
+        const auto& group = groups[prefix];
+        if (std::none_of(group.begin(), group.end(), [](const std::string& name) { return name.empty(); })) {
+            std::cout << "Detected stress component arrays: " << group[XX] << ", " << group[YY] << ", " << group[ZZ]
+                      << ", " << group[XY] << ", " << group[YZ] << ", " << group[XZ] << std::endl;
+            return std::vector<std::string>(group.begin(), group.end());
+        }
+    }
+    return {};
+}
+
+std::string DerivedStress::apply(vtkUnstructuredGrid* grid, const Selection& selection, const Settings& settings,
+                                 bool removeSources, ProcessControl* control)
+{
+    if (!grid || selection.empty()) {
+        return "";
+    }
+    vtkPointData* pointData = grid->GetPointData();
+    const vtkIdType pointCount = grid->GetNumberOfPoints();
+
+    // 成分の取り出し元を決める
+    ComponentSource sources[ComponentCount];
+    if (selection.arrayNames.size() == 1) {
+        const std::string& name = selection.arrayNames.front();
+        vtkDataArray* array = pointData->GetArray(name.c_str());
+        if (!array || array->GetNumberOfTuples() != pointCount) {
+            std::cerr << "Error: Stress array '" << name << "' was not loaded." << std::endl;
+            return "";
+        }
+        const int components = array->GetNumberOfComponents();
+        if (components == 1) {
+            if (settings.quantity == Quantity::Auto) {
+                pointData->SetActiveScalars(name.c_str());
+                return name;
+            }
+            std::cerr << "Error: " << getQuantityName(settings.quantity) << " requires stress tensor components, but '"
+                      << name << "' is a scalar array." << std::endl;
+            return "";
+        }
+        if (components != 6 && components != 9) {
+            std::cerr << "Error: Stress array '" << name << "' has " << components
+                      << " components (expected 1, 6 or 9)." << std::endl;
+            return "";
+        }
+        const int* layout = components == 6 ? SYMMETRIC_TENSOR_COMPONENTS : FULL_TENSOR_COMPONENTS;
+        for (int c = 0; c < ComponentCount; ++c) {
+            sources[c] = {array, layout[c]};
+        }
+    } else if (selection.arrayNames.size() == ComponentCount) {
+        for (int c = 0; c < ComponentCount; ++c) {
+            vtkDataArray* array = pointData->GetArray(selection.arrayNames[c].c_str());
+            if (!array || array->GetNumberOfComponents() != 1 || array->GetNumberOfTuples() != pointCount) {
+                std::cerr << "Error: Stress component array '" << selection.arrayNames[c] << "' was not loaded."
+                          << std::endl;
+                return "";
+            }
+            sources[c] = {array, 0};
+        }
+    } else {
+        return "";
+    }
+    if (settings.quantity == Quantity::SafetyFactor && !(settings.yieldStrength > 0.0)) {
+        std::cerr << "Error: Safety factor requires a positive yield strength." << std::endl;
+        return "";
+    }
+    if (settings.quantity == Quantity::SafetyFactor && !(settings.maxSafetyFactor > 0.0)) {
+        std::cerr << "Error: Safety factor requires a positive maximum safety factor." << std::endl;
+        return "";
+    }
+
+    Profiler::Scope profile("Derive stress");
+    bool doublePrecision = false;
+    for (const auto& source : sources) {
+        doublePrecision = doublePrecision || source.array->GetDataType() == VTK_DOUBLE;
+    }
+    vtkSmartPointer<vtkDataArray> derived;
+    if (doublePrecision) {
+        derived = vtkSmartPointer<vtkDoubleArray>::New();
+    } else {
+        derived = vtkSmartPointer<vtkFloatArray>::New();
+    }
+    const std::string label = getDerivedLabel(settings.quantity);
+    derived->SetName(label.c_str());
+    derived->SetNumberOfComponents(1);
+    derived->SetNumberOfTuples(pointCount);
+    float* floatOut = doublePrecision ? nullptr : vtkFloatArray::SafeDownCast(derived)->GetPointer(0);
+    double* doubleOut = doublePrecision ? vtkDoubleArray::SafeDownCast(derived)->GetPointer(0) : nullptr;
+
+    const size_t chunkCount = static_cast<size_t>((pointCount + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    ParallelUtility::parallelFor(chunkCount, [&](size_t chunk) {
+        if (control && control->isCancelled()) {
+            return;
+        }
+        const vtkIdType begin = static_cast<vtkIdType>(chunk) * CHUNK_SIZE;
+        const vtkIdType count = std::min(CHUNK_SIZE, pointCount - begin);
+        std::vector<double> buffer(static_cast<size_t>(ComponentCount * CHUNK_SIZE));
+        const double* components[ComponentCount];
+        for (int c = 0; c < ComponentCount; ++c) {
+            double* values = buffer.data() + c * CHUNK_SIZE;
+            gatherComponent(values, sources[c], begin, count);
+            components[c] = values;
+        }
+        if (doublePrecision) {
+            computeRange(doubleOut + begin, components, count, settings.quantity, settings.yieldStrength,
+                         settings.maxSafetyFactor);
+        } else {
+            computeRange(floatOut + begin, components, count, settings.quantity, settings.yieldStrength,
+                         settings.maxSafetyFactor);
+        }
+    });
+    if (control && control->isCancelled()) {
+        return "";
+    }
+
+    if (removeSources) {
+        for (const auto& name : selection.arrayNames) {
+            pointData->RemoveArray(name.c_str());
+        }
+    }
+    pointData->AddArray(derived);
+    pointData->SetActiveScalars(label.c_str());
+    profile.addCount("points", pointCount);
+    std::cout << "Derived " << label << " from " << (selection.arrayNames.size() == 1 ? "tensor" : "component")
+              << " arrays" << std::endl;
+    return label;
+}
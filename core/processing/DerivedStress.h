@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <vtkUnstructuredGrid.h>
+
+class ProcessControl;
+
+// 応力テンソルから、バンド分割に使うスカラーの応力（相当応力など）を求める関数
+// ソルバーがテンソル（6 / 9成分の配列）や成分ごとの配列のみを出力する場合に、
+// 読み込み時にスカラー配列を作成してアクティブスカラーに設定する
+class DerivedStress {
+public:
+    enum class Quantity {
+        Auto,         // スカラーの応力配列があればそのまま使い、なければテンソルからミーゼス応力を求める
+        VonMises,     // ミーゼス相当応力
+        MaxPrincipal, // 最大主応力
+        Tresca,       // トレスカ相当応力（最大主応力 - 最小主応力）
+        SafetyFactor  // 安全率（降伏応力 / ミーゼス相当応力、maxSafetyFactor で頭打ち）
+    };
+
+    struct Settings {
+        Quantity quantity = Quantity::Auto;
+        double yieldStrength = 0.0; // SafetyFactor で使う降伏応力
+        // SafetyFactor の上限。安全率は他の量と逆に値が大きいほど応力が小さい（余裕がある）ことを表し、
+        // 応力がほぼ 0 の点で発散した値がバンド分割の範囲を支配しないよう、この値で頭打ちにする
+        double maxSafetyFactor = 10.0;
+        // 読み込み結果のキャッシュを区別する文字列（Auto の場合は空）
+        std::string getKey() const;
+    };
+
+    // 読み込む点配列
+    struct Selection {
+        // スカラーかテンソルの配列1つ、または成分ごとの配列6つ（xx, yy, zz, xy, yz, xz の順）
+        std::vector<std::string> arrayNames;
+        bool empty() const { return arrayNames.empty(); }
+    };
+
+    // "auto" / "vonMises" / "maxPrincipal" / "tresca" / "safetyFactor" を解釈する（不明な名前の場合は false）
+    static bool parseQuantity(const std::string& name, Quantity& quantity);
+    static std::string getQuantityName(Quantity quantity);
+
+    // 応力の成分ごとの配列（Sxx, S11, stress_xy など）の名前か
+    static bool isComponentArrayName(const std::string& name);
+    // 6成分がそろった応力の成分配列を xx, yy, zz, xy, yz, xz の順に返す（見つからなければ空）
+    static std::vector<std::string> findComponentArrays(const std::vector<std::string>& arrayNames);
+
+    // 読み込んだ配列から応力のスカラー配列を作成してアクティブスカラーに設定し、その名前を返す
+    // Auto で1成分の配列を選んだ場合はその配列をそのまま使う
+    // removeSources が true の場合、作成に使ったテンソル・成分配列はデータセットから取り除く
+    // 求められない場合・キャンセル時は空文字列を返す
+    static std::string apply(vtkUnstructuredGrid* grid, const Selection& selection, const Settings& settings,
+                             bool removeSources, ProcessControl* control = nullptr);
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+// 分割メッシュの名前（VtkProcessor::generateMeshFileName の出力）に一致する正規表現（名前全体と照合する）
+// キャプチャはバンド番号・最小応力・最大応力
+// 応力は固定小数点で書き出すため指数表記は含まないが、負の値（最小主応力など）はありうる
+inline constexpr const char* DIVIDED_MESH_NAME_PATTERN = R"(dividedMesh(\d+)_(-?\d+(?:\.\d+)?)_(-?\d+(?:\.\d+)?)\.stl)";
+
+// 応力バンドごとの分割メッシュ（ファイルを介さず3MF作成と表示に渡す）
+struct DividedMesh {
+    vtkSmartPointer<vtkPolyData> polyData;
+    std::string name;   // dividedMeshXX_min_max.stl 形式（3MFのメッシュ名・表示名に使用）
+    int number = 0;     // 1始まりのバンド番号
+    float minStress = 0.0f;
+    float maxStress = 0.0f;
+};
@@ -0,0 +1,68 @@
+#include "MappedDataArray.h"
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkUnsignedCharArray.h>
+#include <cstring>
+
+vtkSmartPointer<vtkDataArray> MappedDataArray::create(int type)
+{
+    switch (type) {
+    case VTK_TYPE_INT64:
+        return vtkSmartPointer<vtkTypeInt64Array>::New();
+    case VTK_TYPE_INT32:
+        return vtkSmartPointer<vtkTypeInt32Array>::New();
+    case VTK_TYPE_UINT8:
+        return vtkSmartPointer<vtkUnsignedCharArray>::New();
+    default:
+        return vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(type));
+    }
+}
+
+vtkSmartPointer<vtkDataArray> MappedDataArray::wrap(const std::shared_ptr<MappedFile>& file, std::uint8_t* data,
+                                                    int type, int components, vtkIdType tuples)
+{
+    if (!isAligned(data, type)) {
+        return copy(data, type, components, tuples);
+    }
+    vtkSmartPointer<vtkDataArray> array = create(type);
+    if (!array) {
+        return nullptr;
+    }
+    array->SetNumberOfComponents(components);
+    // save=1: 領域はマップのものなので、配列側では解放しない
+    array->SetVoidArray(data, tuples * components, 1);
+    keepMappingAlive(array, file);
+    return array;
+}
+
+vtkSmartPointer<vtkDataArray> MappedDataArray::copy(const std::uint8_t* data, int type, int components,
+                                                    vtkIdType tuples)
+{
+    vtkSmartPointer<vtkDataArray> array = create(type);
+    if (!array) {
+        return nullptr;
+    }
+    array->SetNumberOfComponents(components);
+    array->SetNumberOfTuples(tuples);
+    std::memcpy(array->GetVoidPointer(0), data,
+                static_cast<size_t>(tuples) * static_cast<size_t>(components) * static_cast<size_t>(array->GetDataTypeSize()));
+    return array;
+}
+
+bool MappedDataArray::isAligned(const std::uint8_t* data, int type)
+{
+    const int typeSize = vtkDataArray::GetDataTypeSize(type);
+    return typeSize > 0 && reinterpret_cast<std::uintptr_t>(data) % static_cast<std::uintptr_t>(typeSize) == 0;
+}
+
+void MappedDataArray::keepMappingAlive(vtkObject* object, const std::shared_ptr<MappedFile>& file)
+{
+    vtkNew<vtkCallbackCommand> command;
+    command->SetClientData(new std::shared_ptr<MappedFile>(file));
+    command->SetCallback([](vtkObject*, unsigned long, void* clientData, void*) {
+        delete static_cast<std::shared_ptr<MappedFile>*>(clientData);
+    });
+    object->AddObserver(vtkCommand::DeleteEvent, command);
+}
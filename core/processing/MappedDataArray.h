@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include "../../utils/mappedFile.h"
+
+// メモリにマップしたファイルの領域を、コピーせずにVTKの配列として参照するための関数
+// 配列はマップへの参照を保持するため、データセットが使われている間はマップが解除されない
+class MappedDataArray {
+public:
+    // type 型（VTK_FLOAT など）の空の配列を作成する
+    // 整数型のセル配列（VTK_TYPE_INT32 / VTK_TYPE_INT64）は vtkCellArray にそのまま渡せる型で作成する
+    static vtkSmartPointer<vtkDataArray> create(int type);
+    // data から始まる tuples 個のタプルを type 型の配列として参照する
+    // 領域が要素サイズの倍数の位置にない場合は、参照せずにコピーした配列を返す
+    // 配列はマップを保持し続けるため、アプリケーションが rename で置き換えるファイル（バイナリキャッシュ）にのみ使い、
+    // 他のプログラムが上書きしうる入力ファイルには copy を使うこと
+    static vtkSmartPointer<vtkDataArray> wrap(const std::shared_ptr<MappedFile>& file, std::uint8_t* data,
+                                              int type, int components, vtkIdType tuples);
+    // data から始まる tuples 個のタプルをコピーした type 型の配列を作成する
+    static vtkSmartPointer<vtkDataArray> copy(const std::uint8_t* data, int type, int components, vtkIdType tuples);
+    // data が type 型の配列として参照できる位置（要素サイズの倍数）にあるか
+    static bool isAligned(const std::uint8_t* data, int type);
+    // 配列が破棄されるまでマップを保持する
+    static void keepMappingAlive(vtkObject* object, const std::shared_ptr<MappedFile>& file);
+};
@@ -0,0 +1,85 @@
+#include "ProcessControl.h"
+#include <vtkAlgorithm.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
+#include <vtkSmartPointer.h>
+#include <algorithm>
+
+void ProcessControl::setProgressCallback(ProgressCallback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    progressCallback = std::move(callback);
+}
+
+void ProcessControl::throwIfCancelled() const
+{
+    if (isCancelled()) {
+        throw ProcessCancelledError();
+    }
+}
+
+void ProcessControl::beginStage(const std::string& stage, int startPercent, int endPercent)
+{
+    throwIfCancelled();
+    ProgressCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentStage = stage;
+        stageStart = startPercent;
+        stageEnd = endPercent;
+        lastPercent = startPercent;
+        callback = progressCallback;
+    }
+    if (callback) {
+        callback(stage, startPercent);
+    }
+}
+
+void ProcessControl::reportProgress(double fraction)
+{
+    ProgressCallback callback;
+    std::string stage;
+    int percent;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fraction = std::clamp(fraction, 0.0, 1.0);
+        percent = stageStart + static_cast<int>(fraction * (stageEnd - stageStart));
+        // 同じ値の通知は間引く
+        if (percent <= lastPercent) {
+            return;
+        }
+        lastPercent = percent;
+        stage = currentStage;
+        callback = progressCallback;
+    }
+    if (callback) {
+        callback(stage, percent);
+    }
+}
+
+void ProcessControl::observe(vtkAlgorithm* algorithm, bool reportProgress)
+{
+    if (!algorithm) return;
+    vtkSmartPointer<vtkCallbackCommand> command = vtkSmartPointer<vtkCallbackCommand>::New();
+    command->SetCallback(reportProgress ? &ProcessControl::onVtkProgress : &ProcessControl::onVtkProgressAbortOnly);
+    command->SetClientData(this);
+    algorithm->AddObserver(vtkCommand::ProgressEvent, command);
+}
+
+void ProcessControl::onVtkProgress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    onVtkProgressAbortOnly(caller, eventId, clientData, callData);
+    ProcessControl* control = static_cast<ProcessControl*>(clientData);
+    if (callData) {
+        control->reportProgress(*static_cast<double*>(callData));
+    }
+}
+
+void ProcessControl::onVtkProgressAbortOnly(vtkObject* caller, unsigned long, void* clientData, void*)
+{
+    ProcessControl* control = static_cast<ProcessControl*>(clientData);
+    if (control->isCancelled()) {
+        // フィルタの実行を中断させる（出力は不完全になるため、呼び出し側で破棄する）
+        static_cast<vtkAlgorithm*>(caller)->SetAbortExecute(1);
+    }
+}
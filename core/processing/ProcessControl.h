@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+class vtkAlgorithm;
+class vtkObject;
+
+// 処理がキャンセルされたことを表す例外
+class ProcessCancelledError : public std::runtime_error {
+public:
+    ProcessCancelledError() : std::runtime_error("Processing cancelled") {}
+};
+
+// パイプラインの進捗通知と協調的キャンセルを管理するクラス
+// GUIに依存せず、ワーカースレッドから呼び出される前提でスレッドセーフに実装する
+class ProcessControl {
+public:
+    // stage: 現在の段階名, percent: 全体の進捗（0〜100）
+    using ProgressCallback = std::function<void(const std::string& stage, int percent)>;
+
+    void setProgressCallback(ProgressCallback callback);
+
+    // キャンセル要求（任意のスレッドから呼び出し可能）
+    void requestCancel() { cancelled.store(true); }
+    bool isCancelled() const { return cancelled.load(); }
+    // キャンセルされていれば ProcessCancelledError を送出する
+    void throwIfCancelled() const;
+
+    // 段階を開始する。段階内の進捗は全体の [startPercent, endPercent] に割り当てられる
+    void beginStage(const std::string& stage, int startPercent, int endPercent);
+    // 現在の段階内での進捗（0.0〜1.0）を通知する
+    void reportProgress(double fraction);
+
+    // VTKフィルタの ProgressEvent を監視し、キャンセル時に AbortExecute を設定する
+    // reportProgress が true の場合はフィルタの進捗を現在の段階の進捗として通知する
+    // （複数のフィルタを並列に実行する場合は false にする）
+    void observe(vtkAlgorithm* algorithm, bool reportProgress = true);
+
+private:
+    static void onVtkProgress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    static void onVtkProgressAbortOnly(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    ProgressCallback progressCallback;
+    std::string currentStage;
+    int stageStart = 0;
+    int stageEnd = 100;
+    int lastPercent = -1;
+};
@@ -1,44 +1,57 @@
 #include "ProcessPipeline.h"
 #include "VtkProcessor.h"
 #include "lib3mfProcessor.h"
-#include "../../utils/fileUtility.h"
-#include "../../utils/tempPathUtility.h"
-#include <QMessageBox>
+#include "DatasetCache.h"
+#include "ProcessControl.h"
+#include "ResultCache.h"
+#include "Workspace.h"
+#include "../../utils/profiler.h"
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
+#include <utility>
 #include <vtkPolyData.h>
 
 ProcessPipeline::ProcessPipeline() {
     vtkProcessor = std::make_unique<VtkProcessor>("");
+    setWorkspace(Workspace::create());
 }
 
 ProcessPipeline::~ProcessPipeline() = default;
 
+void ProcessPipeline::setProcessControl(ProcessControl* control) {
+    processControl = control;
+    vtkProcessor->setProcessControl(control);
+}
+
+void ProcessPipeline::setWorkspace(std::shared_ptr<Workspace> workspace) {
+    this->workspace = std::move(workspace);
+    vtkProcessor->setWorkspace(this->workspace.get());
+}
+
 bool ProcessPipeline::initializeVtkProcessor(const std::string& vtkFile, const std::string& stlFile, 
-                                          const std::vector<double>& thresholds, QWidget* parent) {
+                                          const std::vector<double>& thresholds) {
+    Profiler::Scope profile("Initialize VTK processor");
     this->vtkFile = vtkFile;
     this->stlFile = stlFile;
+    dividedMeshes.clear();
     
     vtkProcessor->clearPreviousData();
     if (vtkFile.empty()) {
-        if (parent) {
-            QMessageBox::warning(parent, "Warning", "No VTK file selected");
-        }
+        std::cerr << "Warning: No VTK file selected" << std::endl;
         return false;
     }
     if (stlFile.empty()) {
-        if (parent) {
-            QMessageBox::warning(parent, "Warning", "No STL file selected");
-        }
+        std::cerr << "Warning: No STL file selected" << std::endl;
         return false;
     }
     
     // VtkProcessorにファイル名を設定し、データを読み込む
     vtkProcessor->setVtuFileName(vtkFile);
     if (!vtkProcessor->LoadAndPrepareData()) {
-        if (parent) {
-            QMessageBox::critical(parent, "Error", "Failed to load VTK file: " + QString::fromStdString(vtkFile));
-        }
+        std::cerr << "Error: Failed to load VTK file: " << vtkFile << std::endl;
         return false;
     }
     
@@ -47,58 +60,230 @@ bool ProcessPipeline::initializeVtkProcessor(const std::string& vtkFile, const s
     return true;
 }
 
+bool ProcessPipeline::prepareVtkData(const std::string& vtkFile) {
+    Profiler::Scope profile("Prepare VTK data");
+    if (vtkFile.empty()) {
+        return false;
+    }
+    vtkProcessor->setVtuFileName(vtkFile);
+    if (!vtkProcessor->LoadAndPrepareData()) {
+        std::cerr << "Error: Failed to prepare VTK file: " << vtkFile << std::endl;
+        return false;
+    }
+    // プログレッシブ表示で使う外表面も先に構築しておく
+    vtkProcessor->getOuterSurface();
+    return true;
+}
+
 std::vector<vtkSmartPointer<vtkPolyData>> ProcessPipeline::processMeshDivision() {
     if (!vtkProcessor) {
         throw std::runtime_error("VtkProcessor not initialized");
     }
-    auto dividedMeshes = vtkProcessor->divideMesh();
-    if (dividedMeshes.empty()) {
+    Profiler::Scope profile("Mesh division");
+    dividedMeshes.clear();
+    auto meshes = vtkProcessor->divideMesh();
+    if (meshes.empty()) {
         throw std::runtime_error("No meshes generated");
     }
-    return dividedMeshes;
+    dividedMeshes = vtkProcessor->createDividedMeshList(meshes);
+    return meshes;
+}
+
+std::vector<DividedMesh> ProcessPipeline::processPreviewDivision() {
+    if (!vtkProcessor) {
+        throw std::runtime_error("VtkProcessor not initialized");
+    }
+    return vtkProcessor->createDividedMeshList(vtkProcessor->divideMeshPreview());
+}
+
+void ProcessPipeline::setLoadCaseFiles(const std::vector<std::string>& files, StressEnvelope::Reduction reduction) {
+    vtkProcessor->setLoadCaseFiles(files, reduction);
+}
+
+void ProcessPipeline::setDerivedStress(const DerivedStress::Settings& settings) {
+    vtkProcessor->setDerivedStress(settings);
+}
+
+void ProcessPipeline::adoptDivision(ProcessPipeline& other) {
+    vtkFile = other.vtkFile;
+    stlFile = other.stlFile;
+    dividedMeshes = std::move(other.dividedMeshes);
+    other.dividedMeshes.clear();
+    divisionMaxStress = other.getMaxStress();
 }
 
 bool ProcessPipeline::process3mfFile(const std::string& mode, const std::vector<StressDensityMapping>& mappings, 
-                                  double maxStress, QWidget* parent) {
+                                  double maxStress, const std::string& outputPath) {
+    Profiler::Scope profile("3MF generation");
     try {
         Lib3mfProcessor lib3mfProcessor;
+        lib3mfProcessor.setProcessControl(processControl);
+        lib3mfProcessor.setWorkspace(workspace.get());
         if (!loadInputFiles(lib3mfProcessor, stlFile)) {
             throw std::runtime_error("Failed to load input files");
         }
         QString currentMode = QString::fromStdString(mode);
-        if (!processByMode(lib3mfProcessor, currentMode, mappings, maxStress)) {
+        if (!processByMode(lib3mfProcessor, currentMode, mappings, maxStress, outputPath)) {
             throw std::runtime_error("Failed to process in " + mode + " mode");
         }
         return true;
     }
+    catch (const ProcessCancelledError&) {
+        // キャンセルはエラーとして扱わず呼び出し側へ伝える
+        throw;
+    }
     catch (const std::exception& e) {
-        handle3mfError(e, parent);
+        handle3mfError(e);
         return false;
     }
 }
 
+std::string ProcessPipeline::makeResultCacheKey(const std::string& vtkFile, const std::string& stlFile,
+                                                const std::vector<double>& thresholds,
+                                                const std::vector<StressDensityMapping>& mappings,
+                                                const std::string& mode,
+                                                const std::vector<std::string>& loadCaseFiles,
+                                                StressEnvelope::Reduction reduction) {
+    Profiler::Scope profile("Compute result cache key");
+    ResultCache::KeyBuilder key;
+    // 分割されたデータセットは各ピースの内容も含める
+    auto addDataset = [&key](const std::string& file) {
+        if (!key.addFileContent(file)) {
+            return false;
+        }
+        if (!VtkProcessor::isPartitionedFile(file)) {
+            return true;
+        }
+        const std::vector<std::string> pieceFiles = VtkProcessor::getPieceFileNames(file);
+        if (pieceFiles.empty()) {
+            return false;
+        }
+        for (const auto& pieceFile : pieceFiles) {
+            if (!key.addFileContent(pieceFile)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!addDataset(vtkFile) || !key.addFileContent(stlFile)) {
+        return "";
+    }
+    // 荷重ケースを使わない場合のキーは変えない
+    if (!loadCaseFiles.empty()) {
+        for (const auto& caseFile : loadCaseFiles) {
+            if (!addDataset(caseFile)) {
+                return "";
+            }
+        }
+        key.addString(StressEnvelope::getReductionName(reduction));
+    }
+    // 3MF内のメッシュ名に使われるため、STLのファイル名も含める
+    key.addString(std::filesystem::path(stlFile).filename().string());
+    key.addDoubles(thresholds);
+    std::vector<double> mappingValues;
+    for (const auto& mapping : mappings) {
+        mappingValues.push_back(mapping.stressMin);
+        mappingValues.push_back(mapping.stressMax);
+        mappingValues.push_back(mapping.density);
+    }
+    key.addDoubles(mappingValues);
+    key.addString(mode);
+    return key.build();
+}
+
+bool ProcessPipeline::restoreCachedResult(const std::string& key, const std::string& outputPath) {
+    ResultCache::Result cached;
+    if (key.empty() || !ResultCache::instance().load(key, cached)) {
+        return false;
+    }
+    if (outputPath.empty()) {
+        if (!workspace || !workspace->writeFile(Workspace::RESULT_3MF_PATH, std::move(cached.result3mf))) {
+            return false;
+        }
+    } else {
+        // save3mf と同じく一時ファイルに書き出してから置き換え、失敗時に既存の出力を壊さない
+        const std::string partialPath = outputPath + ".part";
+        bool written = false;
+        {
+            std::ofstream stream(partialPath, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(cached.result3mf.data()),
+                         static_cast<std::streamsize>(cached.result3mf.size()));
+            written = static_cast<bool>(stream.flush());
+        }
+        std::error_code ec;
+        if (written) {
+            std::filesystem::rename(partialPath, outputPath, ec);
+            written = !ec;
+        }
+        if (!written) {
+            std::filesystem::remove(partialPath, ec);
+            std::cerr << "Error: Failed to write 3MF file: " << outputPath << std::endl;
+            return false;
+        }
+    }
+    dividedMeshes = std::move(cached.meshes);
+    return true;
+}
+
+bool ProcessPipeline::storeCachedResult(const std::string& key, const std::string& outputPath) const {
+    if (key.empty() || dividedMeshes.empty()) {
+        return false;
+    }
+    ResultCache::Result result;
+    result.meshes = dividedMeshes;
+    if (outputPath.empty()) {
+        if (!workspace || !workspace->readFile(Workspace::RESULT_3MF_PATH, result.result3mf)) {
+            return false;
+        }
+    } else {
+        std::ifstream stream(outputPath, std::ios::binary);
+        result.result3mf.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        if (result.result3mf.empty()) {
+            return false;
+        }
+    }
+    return ResultCache::instance().store(key, result);
+}
+
 bool ProcessPipeline::loadInputFiles(Lib3mfProcessor& processor, const std::string& stlFile) {
-    if (!processor.getMeshes()) {
+    Profiler::Scope profile("Load 3MF input meshes");
+    // 分割メッシュはファイルを介さずに直接lib3mfのメッシュへ変換する
+    if (dividedMeshes.empty()) {
         throw std::runtime_error("Failed to load divided meshes");
     }
-    if (!processor.setStl(stlFile)) {
+    for (const auto& mesh : dividedMeshes) {
+        if (processControl) processControl->throwIfCancelled();
+        if (!mesh.polyData || mesh.polyData->GetNumberOfPolys() == 0) {
+            std::cerr << "Skipping empty divided mesh: " << mesh.name << std::endl;
+            continue;
+        }
+        if (!processor.addMesh(mesh.polyData, mesh.name)) {
+            throw std::runtime_error("Failed to add divided mesh: " + mesh.name);
+        }
+    }
+    // 表示時に読み込んだSTLを共有し、ファイルの再パースを省略する
+    vtkSmartPointer<vtkPolyData> stlData = DatasetCache::instance().getPolyData(stlFile);
+    profile.addCount("meshes", static_cast<std::int64_t>(dividedMeshes.size()) + 1);
+    const std::string meshName = std::filesystem::path(stlFile).filename().string();
+    if (!stlData || !processor.addMesh(stlData, meshName)) {
         throw std::runtime_error("Failed to load STL file: " + stlFile);
     }
     return true;
 }
 
 bool ProcessPipeline::processByMode(Lib3mfProcessor& processor, const QString& mode, 
-                                 const std::vector<StressDensityMapping>& mappings, double maxStress) {
+                                 const std::vector<StressDensityMapping>& mappings, double maxStress,
+                                 const std::string& outputPath) {
     if (mode == "cura") {
-        return processCuraMode(processor, mappings, maxStress);
+        return processCuraMode(processor, mappings, maxStress, outputPath);
     } else if (mode == "bambu") {
-        return processBambuMode(processor, maxStress, mappings);
+        return processBambuMode(processor, maxStress, mappings, outputPath);
     }
     throw std::runtime_error("Unknown mode: " + mode.toStdString());
 }
 
 bool ProcessPipeline::processCuraMode(Lib3mfProcessor& processor, const std::vector<StressDensityMapping>& mappings, 
-                                   double maxStress) {
+                                   double maxStress, const std::string& outputPath) {
     std::cout << "Processing in Cura mode" << std::endl;
     if (!processor.setMetaData(maxStress, mappings)) {
         throw std::runtime_error("Failed to set metadata");
@@ -106,45 +291,42 @@ bool ProcessPipeline::processCuraMode(Lib3mfProcessor& processor, const std::vec
     if (!processor.assembleObjects()) {
         throw std::runtime_error("Failed to assemble objects");
     }
-    const std::string outputPath = TempPathUtility::getTempFilePath("result/result.3mf").toStdString();
-    if (!processor.save3mf(outputPath)) {
+    if (!saveOutput(processor, outputPath)) {
         throw std::runtime_error("Failed to save 3MF file");
     }
-    std::cout << "Successfully saved 3MF file: " << outputPath << std::endl;
     return true;
 }
 
-bool ProcessPipeline::processBambuMode(Lib3mfProcessor& processor, double maxStress, const std::vector<StressDensityMapping>& mappings) {
+bool ProcessPipeline::processBambuMode(Lib3mfProcessor& processor, double maxStress, const std::vector<StressDensityMapping>& mappings,
+                                       const std::string& outputPath) {
     std::cout << "Processing in Bambu mode" << std::endl;
-    processor.setMetaDataBambu(maxStress, mappings);
-    const std::string tempFile = TempPathUtility::getTempFilePath("result.3mf").toStdString();
-    if (!processor.save3mf(tempFile)) {
-        throw std::runtime_error("Failed to save temporary 3MF file");
+    // model_settings.config は添付ファイルとして登録されるため、1回の書き込みで出力が完成する
+    if (!processor.setMetaDataBambu(maxStress, mappings)) {
+        throw std::runtime_error("Failed to set Bambu metadata");
+    }
+    if (!saveOutput(processor, outputPath)) {
+        throw std::runtime_error("Failed to save 3MF file");
     }
-    return processBambuZipFiles();
+    return true;
 }
 
-bool ProcessPipeline::processBambuZipFiles() {
-    const std::string extractDir = TempPathUtility::getTempSubDirPath("3mf").string();
-    const std::string zipFile = TempPathUtility::getTempFilePath("result.3mf").toStdString();
-    const std::string outputFile = TempPathUtility::getTempFilePath("result/result.3mf").toStdString();
-    if (!FileUtility::unzipFile(zipFile, extractDir)) {
-        throw std::runtime_error("Failed to extract ZIP file");
+bool ProcessPipeline::saveOutput(Lib3mfProcessor& processor, const std::string& outputPath) {
+    if (!outputPath.empty()) {
+        if (!processor.save3mf(outputPath)) {
+            return false;
+        }
+        std::cout << "Successfully saved 3MF file: " << outputPath << std::endl;
+        return true;
     }
-    if (!FileUtility::zipDirectory(extractDir, outputFile)) {
-        throw std::runtime_error("Failed to create output ZIP file");
+    if (!workspace || !processor.save3mf(*workspace, Workspace::RESULT_3MF_PATH)) {
+        return false;
     }
-    std::cout << "Successfully processed Bambu mode files" << std::endl;
+    std::cout << "Successfully saved 3MF file to workspace: " << Workspace::RESULT_3MF_PATH << std::endl;
     return true;
 }
 
-void ProcessPipeline::handle3mfError(const std::exception& e, QWidget* parent) {
+void ProcessPipeline::handle3mfError(const std::exception& e) {
     std::cerr << "3MF Processing Error: " << e.what() << std::endl;
-    if (parent) {
-        QMessageBox::critical(parent, 
-                             "3MF Processing Error", 
-                             QString::fromStdString("Failed to process 3MF file:\n" + std::string(e.what())));
-    }
 }
 
 double ProcessPipeline::getMaxStress() const {
@@ -4,15 +4,17 @@
 #include <vector>
 #include <memory>
 #include <QString>
-#include <QWidget>
-#include <QMessageBox>
 #include <vtkSmartPointer.h>
-#include "../../UI/widgets/DensitySlider.h"
+#include "StressDensityMapping.h"
+#include "DividedMesh.h"
+#include "StressEnvelope.h"
+#include "DerivedStress.h"
 
 class VtkProcessor;
 class Lib3mfProcessor;
 class vtkPolyData;
-class StressDensityMapping;
+class ProcessControl;
+class Workspace;
 
 class ProcessPipeline {
 public:
@@ -21,29 +23,70 @@ public:
 
     // VTKファイル処理
     bool initializeVtkProcessor(const std::string& vtkFile, const std::string& stlFile, 
-                               const std::vector<double>& thresholds, QWidget* parent = nullptr);
+                               const std::vector<double>& thresholds);
+    // 処理に使うVTUの読み込みと応力区間インデックスの構築のみを先に行う
+    // 同じファイルであれば、後の initializeVtkProcessor は読み込みと構築を省略する
+    bool prepareVtkData(const std::string& vtkFile);
+    // 同じメッシュの別の荷重ケースを設定する（以降の読み込みと分割は包絡値で行う、空の場合は解除）
+    void setLoadCaseFiles(const std::vector<std::string>& files,
+                          StressEnvelope::Reduction reduction = StressEnvelope::Reduction::Maximum);
+    // テンソルから求める応力を設定する（既定ではスカラーの応力配列がない場合のみミーゼス応力を求める）
+    void setDerivedStress(const DerivedStress::Settings& settings);
     
-    // メッシュ分割処理
+    // メッシュ分割処理（結果は3MF作成と表示のために保持する）
     std::vector<vtkSmartPointer<vtkPolyData>> processMeshDivision();
+    const std::vector<DividedMesh>& getDividedMeshes() const { return dividedMeshes; }
+    // 外表面のみを分割した粗いプレビュー（結果は保持せず、3MF作成には使わない）
+    std::vector<DividedMesh> processPreviewDivision();
+    // 別のパイプラインで済ませた分割結果（入力ファイル・分割メッシュ・最大応力）を引き継ぐ
+    // 引き継いだ後は process3mfFile のみで出力できる（出力先は自身の作業領域）
+    // other を操作する他のスレッドがない状態で呼び出すこと
+    void adoptDivision(ProcessPipeline& other);
+    // adoptDivision で引き継いだ分割時の最大応力（引き継ぎ後に other が読み込み直しても変わらない）
+    double getDivisionMaxStress() const { return divisionMaxStress; }
     
-    // 3MFファイル処理
+    // 3MFファイル処理（outputPath が空の場合は作業領域の Workspace::RESULT_3MF_PATH に出力する）
     bool process3mfFile(const std::string& mode, const std::vector<StressDensityMapping>& mappings, 
-                       double maxStress, QWidget* parent = nullptr);
+                       double maxStress, const std::string& outputPath = "");
     
+    // 結果キャッシュ（ResultCache）のキーを、入力ファイルの内容・しきい値・マッピング・モードから求める
+    // 荷重ケースを指定した場合は各ケースの内容と集約方法も含める
+    // 入力ファイルを読めない場合は空文字列を返す
+    static std::string makeResultCacheKey(const std::string& vtkFile, const std::string& stlFile,
+                                          const std::vector<double>& thresholds,
+                                          const std::vector<StressDensityMapping>& mappings,
+                                          const std::string& mode,
+                                          const std::vector<std::string>& loadCaseFiles = {},
+                                          StressEnvelope::Reduction reduction = StressEnvelope::Reduction::Maximum);
+    // キャッシュ済みの結果があれば、分割メッシュと3MF（outputPath が空の場合は作業領域）を復元する
+    // 成功した場合は分割と process3mfFile を省略できる
+    bool restoreCachedResult(const std::string& key, const std::string& outputPath = "");
+    // 直近の分割メッシュと process3mfFile の出力を結果キャッシュへ保存する
+    bool storeCachedResult(const std::string& key, const std::string& outputPath = "") const;
+
     // ファイル読み込み
     bool loadInputFiles(Lib3mfProcessor& processor, const std::string& stlFile);
     
     // モード別処理
     bool processByMode(Lib3mfProcessor& processor, const QString& mode, 
-                      const std::vector<StressDensityMapping>& mappings, double maxStress);
+                      const std::vector<StressDensityMapping>& mappings, double maxStress,
+                      const std::string& outputPath);
     bool processCuraMode(Lib3mfProcessor& processor, const std::vector<StressDensityMapping>& mappings, 
-                        double maxStress);
-    bool processBambuMode(Lib3mfProcessor& processor, double maxStress, const std::vector<StressDensityMapping>& mappings);
-    bool processBambuZipFiles();
+                        double maxStress, const std::string& outputPath);
+    bool processBambuMode(Lib3mfProcessor& processor, double maxStress, const std::vector<StressDensityMapping>& mappings,
+                         const std::string& outputPath);
     
     // エラーハンドリング
-    void handle3mfError(const std::exception& e, QWidget* parent = nullptr);
+    void handle3mfError(const std::exception& e);
     
+    // 進捗通知とキャンセルの制御（処理中のみ設定し、終了後は nullptr に戻す）
+    void setProcessControl(ProcessControl* control);
+
+    // 中間ファイルと出力を置く作業領域（生成時に既定のバックエンドで作成される）
+    // 実行ごとに新しい作業領域を設定することで、前回の結果と同時実行中の他のパイプラインから分離する
+    void setWorkspace(std::shared_ptr<Workspace> workspace);
+    std::shared_ptr<Workspace> getWorkspace() const { return workspace; }
+
     // ゲッター
     std::unique_ptr<VtkProcessor>& getVtkProcessor() { return vtkProcessor; }
     double getMaxStress() const;
@@ -52,4 +95,10 @@ private:
     std::unique_ptr<VtkProcessor> vtkProcessor;
     std::string vtkFile;
     std::string stlFile;
+    std::vector<DividedMesh> dividedMeshes;
+    double divisionMaxStress = 0.0;
+    ProcessControl* processControl = nullptr;
+    std::shared_ptr<Workspace> workspace;
+
+    bool saveOutput(Lib3mfProcessor& processor, const std::string& outputPath);
 }; 
\ No newline at end of file
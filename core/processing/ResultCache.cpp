@@ -0,0 +1,395 @@
+#include "ResultCache.h"
+#include "../../utils/fileUtility.h"
+#include "../../utils/tempPathUtility.h"
+#include "../../utils/profiler.h"
+#include <QCoreApplication>
+#include <vtkSTLReader.h>
+#include <vtkSTLWriter.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+namespace {
+// エントリの形式を変更した場合は番号を上げ、以前のエントリを使わないようにする
+constexpr std::uint64_t CACHE_FORMAT_VERSION = 1;
+constexpr const char* MESH_LIST_FILE = "meshes.txt";
+constexpr const char* RESULT_3MF_FILE = "result.3mf";
+// 書き込み途中で終了したプロセスの一時ディレクトリを削除するまでの時間
+constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+std::atomic<std::uint64_t> tempCounter{0};
+
+constexpr std::uint64_t LANE_SEEDS[2] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL};
+constexpr std::uint64_t LANE_MULTIPLIERS[2][2] = {
+    {0x87c37b91114253d5ULL, 0x4cf5ad432745937fULL},
+    {0xff51afd7ed558ccdULL, 0xc4ceb9fe1a85ec53ULL}};
+
+std::uint64_t rotl(std::uint64_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+void mixWord(std::uint64_t lanes[2], std::uint64_t word)
+{
+    for (int lane = 0; lane < 2; ++lane) {
+        std::uint64_t k = word * LANE_MULTIPLIERS[lane][0];
+        k = rotl(k, 31) * LANE_MULTIPLIERS[lane][1];
+        lanes[lane] ^= k;
+        lanes[lane] = rotl(lanes[lane], 27 + lane * 4) * 5 + 0x52dce729;
+    }
+}
+
+// 8バイト単位で混ぜ、端数は0で埋めた1語として扱う
+void mixBytes(std::uint64_t lanes[2], const std::uint8_t* data, size_t size)
+{
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + offset, 8);
+        mixWord(lanes, word);
+    }
+    if (offset < size) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + offset, size - offset);
+        mixWord(lanes, word);
+    }
+}
+
+std::uint64_t finalizeLane(std::uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+std::filesystem::path getDefaultCacheDir()
+{
+    const char* value = std::getenv("STRECS3D_RESULT_CACHE_DIR");
+    if (value && *value) {
+        return std::filesystem::path(value);
+    }
+    return TempPathUtility::getTempDirPath() / "result-cache";
+}
+
+std::string makeTempName(const std::string& prefix)
+{
+    return prefix + "-" + std::to_string(QCoreApplication::applicationPid()) + "-" + std::to_string(++tempCounter);
+}
+
+std::string bandFileName(int number)
+{
+    std::ostringstream oss;
+    oss << "band-" << std::setw(2) << std::setfill('0') << number << ".stl";
+    return oss.str();
+}
+
+std::uintmax_t getDirectorySize(const std::filesystem::path& directory)
+{
+    std::uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(directory, ec)) {
+        if (file.is_regular_file(ec)) {
+            total += file.file_size(ec);
+        }
+    }
+    return total;
+}
+}
+
+ResultCache::KeyBuilder::KeyBuilder()
+    : lanes{LANE_SEEDS[0], LANE_SEEDS[1]}
+{
+    addWord(CACHE_FORMAT_VERSION);
+}
+
+void ResultCache::KeyBuilder::addWord(std::uint64_t word)
+{
+    mixWord(lanes, word);
+    ++length;
+}
+
+bool ResultCache::KeyBuilder::addFileContent(const std::string& path)
+{
+    std::uint64_t hash[2];
+    if (!ResultCache::instance().hashFile(path, hash)) {
+        return false;
+    }
+    addWord(hash[0]);
+    addWord(hash[1]);
+    return true;
+}
+
+void ResultCache::KeyBuilder::addString(const std::string& value)
+{
+    addWord(value.size());
+    mixBytes(lanes, reinterpret_cast<const std::uint8_t*>(value.data()), value.size());
+    length += (value.size() + 7) / 8;
+}
+
+void ResultCache::KeyBuilder::addDouble(double value)
+{
+    std::uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    addWord(word);
+}
+
+void ResultCache::KeyBuilder::addDoubles(const std::vector<double>& values)
+{
+    addWord(values.size());
+    for (double value : values) {
+        addDouble(value);
+    }
+}
+
+std::string ResultCache::KeyBuilder::build() const
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (std::uint64_t lane : lanes) {
+        oss << std::setw(16) << finalizeLane(lane ^ length);
+    }
+    return oss.str();
+}
+
+ResultCache& ResultCache::instance()
+{
+    static ResultCache cache;
+    return cache;
+}
+
+bool ResultCache::isEnabled()
+{
+    const char* value = std::getenv("STRECS3D_RESULT_CACHE");
+    if (!value) {
+        return true;
+    }
+    const std::string setting(value);
+    return setting != "0" && setting != "off";
+}
+
+ResultCache::ResultCache()
+    : directory(getDefaultCacheDir())
+    , maxBytes(std::uintmax_t(2048) * 1024 * 1024)
+{
+    const char* value = std::getenv("STRECS3D_RESULT_CACHE_MAX_MB");
+    if (value && *value) {
+        maxBytes = static_cast<std::uintmax_t>(std::strtoull(value, nullptr, 10)) * 1024 * 1024;
+    }
+}
+
+void ResultCache::setMaxBytes(std::uintmax_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = bytes;
+}
+
+bool ResultCache::hashFile(const std::string& path, std::uint64_t hash[2])
+{
+    std::error_code ec;
+    const std::uintmax_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    const std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = fileHashes.find(path);
+        if (it != fileHashes.end() && it->second.fileSize == fileSize && it->second.fileTime == fileTime) {
+            hash[0] = it->second.hash[0];
+            hash[1] = it->second.hash[1];
+            return true;
+        }
+    }
+
+    Profiler::Scope profile("Hash input file");
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+    std::uint64_t lanes[2] = {LANE_SEEDS[0], LANE_SEEDS[1]};
+    // 1MiB（8の倍数）ずつ読むため、端数が出るのは最後の読み込みのみ
+    std::vector<char> buffer(1 << 20);
+    while (stream) {
+        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const std::streamsize count = stream.gcount();
+        if (count <= 0) break;
+        mixBytes(lanes, reinterpret_cast<const std::uint8_t*>(buffer.data()), static_cast<size_t>(count));
+    }
+    profile.addCount("bytes", static_cast<std::int64_t>(fileSize));
+
+    FileHash entry;
+    entry.fileSize = fileSize;
+    entry.fileTime = fileTime;
+    entry.hash[0] = finalizeLane(lanes[0] ^ fileSize);
+    entry.hash[1] = finalizeLane(lanes[1] ^ fileSize);
+    hash[0] = entry.hash[0];
+    hash[1] = entry.hash[1];
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fileHashes[path] = entry;
+    return true;
+}
+
+bool ResultCache::load(const std::string& key, Result& result)
+{
+    Profiler::Scope profile("Load cached result");
+    const std::filesystem::path entryDir = directory / "entries" / key;
+    std::ifstream meshList(entryDir / MESH_LIST_FILE);
+    if (!meshList) {
+        return false;
+    }
+
+    Result loaded;
+    std::string line;
+    while (std::getline(meshList, line)) {
+        std::istringstream fields(line);
+        DividedMesh mesh;
+        int hasData = 0;
+        if (!(fields >> mesh.number >> mesh.minStress >> mesh.maxStress >> mesh.name >> hasData)) {
+            std::cerr << "Ignoring malformed result cache entry: " << entryDir << std::endl;
+            return false;
+        }
+        if (hasData) {
+            const std::filesystem::path stlPath = entryDir / bandFileName(mesh.number);
+            if (!std::filesystem::exists(stlPath)) {
+                return false;
+            }
+            vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
+            reader->SetFileName(stlPath.string().c_str());
+            reader->Update();
+            mesh.polyData = reader->GetOutput();
+            // 途中で切れた・壊れたSTLは空のメッシュとして読み込まれるため、キャッシュなしとして扱う
+            if (!mesh.polyData || mesh.polyData->GetNumberOfPolys() == 0) {
+                std::cerr << "Ignoring corrupt result cache entry: " << stlPath << std::endl;
+                return false;
+            }
+        } else {
+            mesh.polyData = vtkSmartPointer<vtkPolyData>::New();
+        }
+        loaded.meshes.push_back(mesh);
+    }
+    // 他のプロセスが削除した直後などで読み込めない場合はキャッシュなしとして扱う
+    if (loaded.meshes.empty() || !FileUtility::readBytes(entryDir / RESULT_3MF_FILE, loaded.result3mf)) {
+        return false;
+    }
+
+    // 最終使用時刻を更新し、削除の対象になりにくくする
+    std::error_code ec;
+    std::filesystem::last_write_time(entryDir / MESH_LIST_FILE, std::filesystem::file_time_type::clock::now(), ec);
+
+    profile.addCount("meshes", static_cast<std::int64_t>(loaded.meshes.size()));
+    profile.addCount("bytes", static_cast<std::int64_t>(loaded.result3mf.size()));
+    result = std::move(loaded);
+    std::cout << "Using cached result: " << key << std::endl;
+    return true;
+}
+
+bool ResultCache::store(const std::string& key, const Result& result)
+{
+    Profiler::Scope profile("Store cached result");
+    const std::filesystem::path entriesDir = directory / "entries";
+    const std::filesystem::path entryDir = entriesDir / key;
+    std::error_code ec;
+    if (std::filesystem::exists(entryDir / MESH_LIST_FILE, ec)) {
+        return true;
+    }
+
+    // 一時ディレクトリにすべて書き出してから rename で公開する
+    const std::filesystem::path tempDir = directory / "tmp" / makeTempName(key);
+    std::filesystem::create_directories(tempDir, ec);
+    std::filesystem::create_directories(entriesDir, ec);
+    if (ec) {
+        std::cerr << "Failed to create result cache directory " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    bool written = FileUtility::writeBytes(tempDir / RESULT_3MF_FILE, result.result3mf);
+    std::ofstream meshList(tempDir / MESH_LIST_FILE);
+    meshList << std::setprecision(9);
+    for (const auto& mesh : result.meshes) {
+        if (!written) break;
+        const bool hasData = mesh.polyData && mesh.polyData->GetNumberOfPolys() > 0;
+        if (hasData) {
+            vtkSmartPointer<vtkSTLWriter> writer = vtkSmartPointer<vtkSTLWriter>::New();
+            writer->SetFileName((tempDir / bandFileName(mesh.number)).string().c_str());
+            writer->SetInputData(mesh.polyData);
+            writer->SetFileTypeToBinary();
+            written = writer->Write() == 1;
+        }
+        meshList << mesh.number << " " << mesh.minStress << " " << mesh.maxStress << " "
+                 << mesh.name << " " << (hasData ? 1 : 0) << "\n";
+    }
+    meshList.close();
+    written = written && static_cast<bool>(meshList);
+
+    if (written) {
+        std::filesystem::rename(tempDir, entryDir, ec);
+        // 他のプロセスが同じキーを先に保存した場合も rename は失敗する（内容は同じなので破棄してよい）
+        written = !ec || std::filesystem::exists(entryDir / MESH_LIST_FILE);
+    }
+    std::filesystem::remove_all(tempDir, ec);
+    if (!written) {
+        std::cerr << "Failed to store result cache entry: " << key << std::endl;
+        return false;
+    }
+
+    profile.addCount("bytes", static_cast<std::int64_t>(getDirectorySize(entryDir)));
+    evict();
+    return true;
+}
+
+void ResultCache::evict()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+
+    // 書き込み途中で終了したプロセスの一時ディレクトリを削除する
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for (const auto& temp : std::filesystem::directory_iterator(directory / "tmp", ec)) {
+        const auto time = temp.last_write_time(ec);
+        if (!ec && now - time > STALE_TEMP_AGE) {
+            std::filesystem::remove_all(temp.path(), ec);
+        }
+    }
+
+    struct EntryInfo {
+        std::filesystem::file_time_type lastUsed;
+        std::filesystem::path path;
+        std::uintmax_t size;
+    };
+    std::vector<EntryInfo> entries;
+    std::uintmax_t totalSize = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory / "entries", ec)) {
+        std::error_code timeError;
+        const auto lastUsed = std::filesystem::last_write_time(entry.path() / MESH_LIST_FILE, timeError);
+        const std::uintmax_t size = getDirectorySize(entry.path());
+        entries.push_back({timeError ? std::filesystem::file_time_type::min() : lastUsed, entry.path(), size});
+        totalSize += size;
+    }
+    if (totalSize <= maxBytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const EntryInfo& a, const EntryInfo& b) { return a.lastUsed < b.lastUsed; });
+    for (const auto& entry : entries) {
+        if (totalSize <= maxBytes) break;
+        // 読み込み中の他のプロセスが不完全なエントリを見ないよう、先に一時ディレクトリへ移してから削除する
+        const std::filesystem::path removed = directory / "tmp" / makeTempName("evict");
+        std::filesystem::rename(entry.path, removed, ec);
+        if (ec) continue;
+        std::filesystem::remove_all(removed, ec);
+        totalSize -= entry.size;
+        std::cout << "Evicted result cache entry: " << entry.path.filename().string() << std::endl;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DividedMesh.h"
+
+// 処理結果（3MFと分割メッシュ）をディスクに保持するキャッシュ
+// キーは入力ファイルの内容と処理条件のハッシュで、同じ条件の再実行では分割と3MF作成を省略できる
+//
+// エントリは一時ディレクトリに書き出してから rename で公開し、削除も rename してから行うため、
+// 同じキャッシュディレクトリを複数のプロセス（CLI・GUI）が同時に使っても不完全なエントリは見えない
+// キャッシュディレクトリは環境変数 STRECS3D_RESULT_CACHE_DIR で変更できる
+class ResultCache {
+public:
+    // キャッシュのキーを作成するクラス（128bit、16進数32文字）
+    // 値の区切りが曖昧にならないよう、可変長の値は長さと合わせてハッシュする
+    class KeyBuilder {
+    public:
+        KeyBuilder();
+        // ファイルの内容をハッシュする（同じパス・サイズ・更新日時のファイルはプロセス内で一度だけ読む）
+        bool addFileContent(const std::string& path);
+        void addString(const std::string& value);
+        void addDouble(double value);
+        void addDoubles(const std::vector<double>& values);
+        std::string build() const;
+
+    private:
+        void addWord(std::uint64_t word);
+        std::uint64_t lanes[2];
+        std::uint64_t length = 0;
+    };
+
+    struct Result {
+        std::vector<std::uint8_t> result3mf;
+        std::vector<DividedMesh> meshes;
+    };
+
+    static ResultCache& instance();
+
+    // 環境変数 STRECS3D_RESULT_CACHE に "0" または "off" を指定すると無効
+    static bool isEnabled();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // キーに対応するエントリがあれば読み込む（見つからない・読み込めない場合は false）
+    bool load(const std::string& key, Result& result);
+    // エントリを保存し、上限サイズを超えた場合は最も長く使われていないエントリから削除する
+    // 同じキーのエントリが既にある場合（他のプロセスが先に保存した場合を含む）は何もしない
+    bool store(const std::string& key, const Result& result);
+
+    const std::filesystem::path& getDirectory() const { return directory; }
+    // キャッシュ全体の上限サイズ（既定 2GiB、環境変数 STRECS3D_RESULT_CACHE_MAX_MB で変更できる）
+    void setMaxBytes(std::uintmax_t bytes);
+
+private:
+    ResultCache();
+
+    struct FileHash {
+        std::uintmax_t fileSize = 0;
+        std::filesystem::file_time_type fileTime;
+        std::uint64_t hash[2] = {0, 0};
+    };
+
+    bool hashFile(const std::string& path, std::uint64_t hash[2]);
+    void evict();
+
+    std::filesystem::path directory;
+    std::uintmax_t maxBytes;
+    std::mutex mutex;
+    std::map<std::string, FileHash> fileHashes;
+};
@@ -0,0 +1,318 @@
+#include "StressBandDivider.h"
+#include "ProcessControl.h"
+#include "../../utils/parallelUtility.h"
+#include "../../utils/profiler.h"
+#include <vtkAppendFilter.h>
+#include <vtkClipDataSet.h>
+#include <vtkClipPolyData.h>
+#include <vtkDataObject.h>
+#include <vtkExtractCells.h>
+#include <vtkGeometryFilter.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+StressBandDivider::StressBandDivider(vtkUnstructuredGrid* grid, const std::string& stressLabel,
+                                     const StressIntervalIndex* index)
+    : grid(grid), stressLabel(stressLabel), index(index)
+{
+    if (!this->index || !this->index->isBuilt()) {
+        ownIndex.build(grid, stressLabel);
+        this->index = &ownIndex;
+    }
+}
+
+void StressBandDivider::classifyCells(const std::vector<float>& stressValues, const std::vector<int>& bandIndices)
+{
+    Profiler::Scope profile("Classify cells");
+    this->stressValues = stressValues;
+    bandInsideIds.clear();
+    bandStraddlingIds.clear();
+    if (!grid || stressValues.size() < 2) return;
+
+    const int bandCount = static_cast<int>(stressValues.size()) - 1;
+    for (int i = 0; i < bandCount; ++i) {
+        bandInsideIds.push_back(vtkSmartPointer<vtkIdList>::New());
+        bandStraddlingIds.push_back(vtkSmartPointer<vtkIdList>::New());
+    }
+
+    // 分類対象のバンド（未指定なら全バンド）
+    std::vector<char> bandRequested(bandCount, bandIndices.empty() ? 1 : 0);
+    for (int b : bandIndices) {
+        if (b >= 0 && b < bandCount) bandRequested[b] = 1;
+    }
+
+    // バンド i は [stressValues[i], stressValues[i + 1])（最後のバンドのみ上端を含む）
+    // 境界値ちょうどの値しか持たないセルが隣り合う2つのバンドに重複して出力されないよう、上端は含めない
+    const vtkIdType numCells = index->getCellCount();
+    for (vtkIdType cellId = 0; cellId < numCells; ++cellId) {
+        if (control && (cellId & 0xFFFF) == 0) {
+            control->throwIfCancelled();
+        }
+        const float cellMin = index->getCellMin(cellId);
+        const float cellMax = index->getCellMax(cellId);
+
+        // stressValues[b + 1] > cellMin となる最初のバンド（最後のバンドは上端と等しい場合も含む）
+        int firstBand = static_cast<int>(
+            std::upper_bound(stressValues.begin() + 1, stressValues.end(), cellMin) - (stressValues.begin() + 1));
+        if (firstBand == bandCount && cellMin == stressValues.back()) {
+            firstBand = bandCount - 1;
+        }
+        // stressValues[b] < cellMax となる最後のバンド
+        // （値が一定のセルは stressValues[b] <= cellMax とし、下端ちょうどの値のセルをそのバンドに含める）
+        const auto lastLower = cellMin < cellMax
+            ? std::lower_bound(stressValues.begin(), stressValues.end() - 1, cellMax)
+            : std::upper_bound(stressValues.begin(), stressValues.end() - 1, cellMax);
+        const int lastBand = static_cast<int>(lastLower - stressValues.begin()) - 1;
+
+        for (int b = firstBand; b <= lastBand; ++b) {
+            if (!bandRequested[b]) continue;
+            const bool belowUpper = b == bandCount - 1 ? cellMax <= stressValues[b + 1] : cellMax < stressValues[b + 1];
+            if (cellMin >= stressValues[b] && belowUpper) {
+                bandInsideIds[b]->InsertNextId(cellId);
+            } else {
+                bandStraddlingIds[b]->InsertNextId(cellId);
+            }
+        }
+    }
+
+    profile.addCount("cells", numCells);
+    std::cout << "Classified " << numCells << " cells into " << bandCount << " bands in a single pass" << std::endl;
+}
+
+vtkIdType StressBandDivider::getBandCellCount(int bandIndex) const
+{
+    if (bandIndex < 0 || bandIndex >= getBandCount()) return 0;
+    return bandInsideIds[bandIndex]->GetNumberOfIds() + bandStraddlingIds[bandIndex]->GetNumberOfIds();
+}
+
+vtkIdType StressBandDivider::getBandStraddlingCellCount(int bandIndex) const
+{
+    if (bandIndex < 0 || bandIndex >= getBandCount()) return 0;
+    return bandStraddlingIds[bandIndex]->GetNumberOfIds();
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressBandDivider::extractCells(vtkIdList* cellIds) const
+{
+    if (!cellIds || cellIds->GetNumberOfIds() == 0) {
+        return vtkSmartPointer<vtkUnstructuredGrid>::New();
+    }
+
+    vtkSmartPointer<vtkExtractCells> extractCells = vtkSmartPointer<vtkExtractCells>::New();
+    extractCells->SetInputData(grid);
+    extractCells->SetCellList(cellIds);
+    extractCells->Update();
+
+    vtkSmartPointer<vtkUnstructuredGrid> subset = extractCells->GetOutput();
+    return subset;
+}
+
+StressBandDivider::BandSubsets StressBandDivider::extractBandSubsets(int bandIndex) const
+{
+    BandSubsets subsets;
+    if (bandIndex < 0 || bandIndex >= getBandCount()) {
+        subsets.inside = vtkSmartPointer<vtkUnstructuredGrid>::New();
+        subsets.straddling = vtkSmartPointer<vtkUnstructuredGrid>::New();
+        return subsets;
+    }
+    subsets.inside = extractCells(bandInsideIds[bandIndex]);
+    subsets.straddling = extractCells(bandStraddlingIds[bandIndex]);
+    return subsets;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressBandDivider::buildBandGrid(const BandSubsets& subsets, int bandIndex) const
+{
+    // しきい値をまたぐセルのみクリップする
+    // クリップ結果はセル単位で決まり、範囲内のセルはクリップしても元のまま出力されるため、
+    // 全体をクリップした場合と同じ形状になる
+    vtkSmartPointer<vtkUnstructuredGrid> clipped;
+    if (subsets.straddling->GetNumberOfCells() > 0) {
+        clipped = clipRange(subsets.straddling, stressLabel,
+                            stressValues[bandIndex], stressValues[bandIndex + 1], control);
+    }
+
+    if (!clipped || clipped->GetNumberOfCells() == 0) {
+        return subsets.inside;
+    }
+    if (subsets.inside->GetNumberOfCells() == 0) {
+        return clipped;
+    }
+
+    // 共有面が内部面として取り除かれるよう、重複点を統合して結合する
+    vtkSmartPointer<vtkAppendFilter> appendFilter = vtkSmartPointer<vtkAppendFilter>::New();
+    appendFilter->AddInputData(subsets.inside);
+    appendFilter->AddInputData(clipped);
+    appendFilter->MergePointsOn();
+    appendFilter->Update();
+
+    vtkSmartPointer<vtkUnstructuredGrid> merged = appendFilter->GetOutput();
+    return merged;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressBandDivider::extractBandGrid(int bandIndex) const
+{
+    return buildBandGrid(extractBandSubsets(bandIndex), bandIndex);
+}
+
+vtkSmartPointer<vtkPolyData> StressBandDivider::extractBand(int bandIndex) const
+{
+    return extractSurface(extractBandGrid(bandIndex));
+}
+
+std::vector<vtkSmartPointer<vtkPolyData>> StressBandDivider::extractBands(const std::vector<int>& bandIndices) const
+{
+    const size_t count = bandIndices.size();
+
+    // 共有の入力グリッドを読むセル抽出は呼び出しスレッドで順に行い、
+    // 各バンドが独立したデータを持ってからクリップと表面抽出を並列に実行する
+    std::vector<BandSubsets> subsets(count);
+    {
+        Profiler::Scope profile("Extract band cells");
+        for (size_t i = 0; i < count; ++i) {
+            if (control) control->throwIfCancelled();
+            subsets[i] = extractBandSubsets(bandIndices[i]);
+            profile.addCount("cells", subsets[i].inside->GetNumberOfCells() + subsets[i].straddling->GetNumberOfCells());
+        }
+    }
+
+    std::vector<vtkSmartPointer<vtkPolyData>> bands(count);
+    std::atomic<size_t> completed{0};
+    ParallelUtility::parallelFor(count, [&](size_t i) {
+        if (control) control->throwIfCancelled();
+        Profiler::Scope profile("Clip and extract band");
+        profile.addCount("band", bandIndices[i] + 1);
+        profile.addCount("clipped cells", subsets[i].straddling->GetNumberOfCells());
+        vtkSmartPointer<vtkUnstructuredGrid> bandGrid = buildBandGrid(subsets[i], bandIndices[i]);
+        if (bandGrid->GetNumberOfCells() == 0) {
+            bands[i] = vtkSmartPointer<vtkPolyData>::New();
+        } else {
+            bands[i] = extractSurface(bandGrid, control);
+        }
+        profile.addCount("triangles", bands[i]->GetNumberOfPolys());
+        // 並列実行中はフィルタ単位ではなく、完了したバンド数で進捗を通知する
+        if (control) {
+            control->reportProgress(static_cast<double>(++completed) / count);
+        }
+    });
+    return bands;
+}
+
+std::vector<vtkSmartPointer<vtkPolyData>> StressBandDivider::extractAllBands() const
+{
+    std::vector<int> bandIndices;
+    for (int i = 0; i < getBandCount(); ++i) {
+        bandIndices.push_back(i);
+    }
+    return extractBands(bandIndices);
+}
+
+std::vector<vtkSmartPointer<vtkUnstructuredGrid>> StressBandDivider::extractBandGrids(const std::vector<int>& bandIndices) const
+{
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid>> bandGrids;
+    bandGrids.reserve(bandIndices.size());
+    for (int bandIndex : bandIndices) {
+        if (control) control->throwIfCancelled();
+        bandGrids.push_back(extractBandGrid(bandIndex));
+    }
+    return bandGrids;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressBandDivider::mergeGrids(const std::vector<vtkSmartPointer<vtkUnstructuredGrid>>& grids,
+                                                                  ProcessControl* control)
+{
+    std::vector<vtkUnstructuredGrid*> inputs;
+    for (const auto& input : grids) {
+        if (input && input->GetNumberOfCells() > 0) {
+            inputs.push_back(input);
+        }
+    }
+    if (inputs.empty()) {
+        return vtkSmartPointer<vtkUnstructuredGrid>::New();
+    }
+    if (inputs.size() == 1) {
+        return inputs.front();
+    }
+
+    vtkSmartPointer<vtkAppendFilter> appendFilter = vtkSmartPointer<vtkAppendFilter>::New();
+    for (vtkUnstructuredGrid* input : inputs) {
+        appendFilter->AddInputData(input);
+    }
+    appendFilter->MergePointsOn();
+    if (control) control->observe(appendFilter, false);
+    appendFilter->Update();
+    if (control) control->throwIfCancelled();
+
+    vtkSmartPointer<vtkUnstructuredGrid> merged = appendFilter->GetOutput();
+    return merged;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressBandDivider::clipRange(vtkUnstructuredGrid* input,
+                                                                  const std::string& stressLabel,
+                                                                  double lowerBound, double upperBound,
+                                                                  ProcessControl* control)
+{
+    // クリップフィルタ1: lowerBound より大きい領域を保持
+    vtkSmartPointer<vtkClipDataSet> clipMin = vtkSmartPointer<vtkClipDataSet>::New();
+    clipMin->SetInputData(input);
+    clipMin->SetValue(lowerBound);
+    clipMin->SetInsideOut(false);
+    clipMin->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, stressLabel.c_str());
+
+    // クリップフィルタ2: upperBound 以下の領域を保持
+    vtkSmartPointer<vtkClipDataSet> clipMax = vtkSmartPointer<vtkClipDataSet>::New();
+    clipMax->SetInputConnection(clipMin->GetOutputPort());
+    clipMax->SetValue(upperBound);
+    clipMax->SetInsideOut(true);
+    clipMax->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, stressLabel.c_str());
+
+    if (control) {
+        control->observe(clipMin, false);
+        control->observe(clipMax, false);
+    }
+    clipMax->Update();
+    // 中断された場合は出力が不完全なため破棄する
+    if (control) control->throwIfCancelled();
+
+    vtkSmartPointer<vtkUnstructuredGrid> result = clipMax->GetOutput();
+    return result;
+}
+
+vtkSmartPointer<vtkPolyData> StressBandDivider::clipSurfaceRange(vtkPolyData* input,
+                                                                 const std::string& stressLabel,
+                                                                 double lowerBound, double upperBound,
+                                                                 ProcessControl* control)
+{
+    // clipRange と同じく、lowerBound より大きく upperBound 以下の領域を保持
+    vtkSmartPointer<vtkClipPolyData> clipMin = vtkSmartPointer<vtkClipPolyData>::New();
+    clipMin->SetInputData(input);
+    clipMin->SetValue(lowerBound);
+    clipMin->SetInsideOut(false);
+    clipMin->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, stressLabel.c_str());
+
+    vtkSmartPointer<vtkClipPolyData> clipMax = vtkSmartPointer<vtkClipPolyData>::New();
+    clipMax->SetInputConnection(clipMin->GetOutputPort());
+    clipMax->SetValue(upperBound);
+    clipMax->SetInsideOut(true);
+    clipMax->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, stressLabel.c_str());
+
+    if (control) {
+        control->observe(clipMin, false);
+        control->observe(clipMax, false);
+    }
+    clipMax->Update();
+    if (control) control->throwIfCancelled();
+
+    vtkSmartPointer<vtkPolyData> result = clipMax->GetOutput();
+    return result;
+}
+
+vtkSmartPointer<vtkPolyData> StressBandDivider::extractSurface(vtkUnstructuredGrid* input, ProcessControl* control)
+{
+    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
+    geometryFilter->SetInputData(input);
+    if (control) control->observe(geometryFilter, false);
+    geometryFilter->Update();
+    if (control) control->throwIfCancelled();
+    vtkSmartPointer<vtkPolyData> polyData = geometryFilter->GetOutput();
+    return polyData;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkIdList.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+#include "StressIntervalIndex.h"
+
+class ProcessControl;
+
+// 応力しきい値で区切られたバンドごとにメッシュを切り出すクラス
+// セルごとの応力区間を使って全セルを一度だけ分類し、
+// バンド内に完全に収まるセルはそのままコピー、しきい値をまたぐセルだけをクリップする
+class StressBandDivider {
+public:
+    // index が未指定（または未構築）の場合は内部で構築する
+    StressBandDivider(vtkUnstructuredGrid* grid, const std::string& stressLabel,
+                      const StressIntervalIndex* index = nullptr);
+    StressBandDivider(const StressBandDivider&) = delete;
+    StressBandDivider& operator=(const StressBandDivider&) = delete;
+
+    // 進捗通知とキャンセルの制御（nullptr の場合は無効）
+    void setProcessControl(ProcessControl* control) { this->control = control; }
+
+    // 全セルを一度だけ走査し、各セルがどのバンドに属するかを分類する
+    // bandIndices を指定した場合は、そのバンドのみを分類対象とする
+    void classifyCells(const std::vector<float>& stressValues, const std::vector<int>& bandIndices = {});
+
+    // 分類結果を使ってバンドの体積メッシュ / 表面メッシュを取得
+    vtkSmartPointer<vtkUnstructuredGrid> extractBandGrid(int bandIndex) const;
+    vtkSmartPointer<vtkPolyData> extractBand(int bandIndex) const;
+
+    // 指定バンドの表面メッシュをバンド単位で並列に生成（結果は bandIndices の順）
+    std::vector<vtkSmartPointer<vtkPolyData>> extractBands(const std::vector<int>& bandIndices) const;
+    std::vector<vtkSmartPointer<vtkPolyData>> extractAllBands() const;
+    // 指定バンドの体積メッシュを順に生成（結果は bandIndices の順）
+    // 分割されたデータセットのピースごとに使い、バンドごとに mergeGrids で結合してから表面を抽出する
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid>> extractBandGrids(const std::vector<int>& bandIndices) const;
+
+    int getBandCount() const { return static_cast<int>(bandInsideIds.size()); }
+    vtkIdType getBandCellCount(int bandIndex) const;
+    vtkIdType getBandStraddlingCellCount(int bandIndex) const;
+
+    // [lowerBound, upperBound] の領域を2回のクリップで切り出す
+    // control を指定した場合、キャンセル時はフィルタを中断して ProcessCancelledError を送出する
+    static vtkSmartPointer<vtkUnstructuredGrid> clipRange(vtkUnstructuredGrid* input,
+                                                          const std::string& stressLabel,
+                                                          double lowerBound, double upperBound,
+                                                          ProcessControl* control = nullptr);
+    // 点データに応力を持つ表面メッシュから [lowerBound, upperBound] の部分を切り出す
+    static vtkSmartPointer<vtkPolyData> clipSurfaceRange(vtkPolyData* input,
+                                                         const std::string& stressLabel,
+                                                         double lowerBound, double upperBound,
+                                                         ProcessControl* control = nullptr);
+    // 複数の体積メッシュを、重複点を統合して結合する（ピースの境界面は内部面として取り除かれる）
+    static vtkSmartPointer<vtkUnstructuredGrid> mergeGrids(const std::vector<vtkSmartPointer<vtkUnstructuredGrid>>& grids,
+                                                           ProcessControl* control = nullptr);
+    // 体積メッシュの外表面をポリゴンとして抽出
+    static vtkSmartPointer<vtkPolyData> extractSurface(vtkUnstructuredGrid* input,
+                                                       ProcessControl* control = nullptr);
+
+private:
+    // バンド内に完全に収まるセルと、しきい値をまたぐセルの部分メッシュ
+    struct BandSubsets {
+        vtkSmartPointer<vtkUnstructuredGrid> inside;
+        vtkSmartPointer<vtkUnstructuredGrid> straddling;
+    };
+
+    BandSubsets extractBandSubsets(int bandIndex) const;
+    vtkSmartPointer<vtkUnstructuredGrid> extractCells(vtkIdList* cellIds) const;
+    vtkSmartPointer<vtkUnstructuredGrid> buildBandGrid(const BandSubsets& subsets, int bandIndex) const;
+
+    vtkUnstructuredGrid* grid;
+    std::string stressLabel;
+    const StressIntervalIndex* index;
+    ProcessControl* control = nullptr;
+    StressIntervalIndex ownIndex;
+    std::vector<float> stressValues;
+    std::vector<vtkSmartPointer<vtkIdList>> bandInsideIds;     // バンド内に収まるセルID
+    std::vector<vtkSmartPointer<vtkIdList>> bandStraddlingIds; // しきい値をまたぐセルID
+};
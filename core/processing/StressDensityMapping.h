@@ -0,0 +1,8 @@
+#pragma once
+
+// 応力範囲と密度のマッピング構造体
+struct StressDensityMapping {
+    double stressMin;
+    double stressMax;
+    double density;
+};
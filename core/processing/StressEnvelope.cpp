@@ -0,0 +1,229 @@
+#include "StressEnvelope.h"
+#include "ProcessControl.h"
+#include "../../utils/parallelUtility.h"
+#include "../../utils/profiler.h"
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedCharArray.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// 並列処理の単位（ケースごとの入力がキャッシュに収まる大きさ）
+constexpr vtkIdType CHUNK_SIZE = 16384;
+
+// 分岐をループの外に置き、内側を要素ごとの単純な演算にしてコンパイラの自動ベクトル化を効かせる
+template <typename Out, typename In>
+void reduceRange(Out* out, const In* in, vtkIdType count, StressEnvelope::Reduction reduction, bool first)
+{
+    using Reduction = StressEnvelope::Reduction;
+    if (first) {
+        if (reduction == Reduction::MaximumAbsolute) {
+            for (vtkIdType i = 0; i < count; ++i) {
+                out[i] = std::abs(static_cast<Out>(in[i]));
+            }
+        } else {
+            for (vtkIdType i = 0; i < count; ++i) {
+                out[i] = static_cast<Out>(in[i]);
+            }
+        }
+        return;
+    }
+    switch (reduction) {
+    case Reduction::Maximum:
+        for (vtkIdType i = 0; i < count; ++i) {
+            const Out v = static_cast<Out>(in[i]);
+            out[i] = out[i] < v ? v : out[i];
+        }
+        break;
+    case Reduction::MaximumAbsolute:
+        for (vtkIdType i = 0; i < count; ++i) {
+            const Out v = std::abs(static_cast<Out>(in[i]));
+            out[i] = out[i] < v ? v : out[i];
+        }
+        break;
+    case Reduction::Minimum:
+        for (vtkIdType i = 0; i < count; ++i) {
+            const Out v = static_cast<Out>(in[i]);
+            out[i] = v < out[i] ? v : out[i];
+        }
+        break;
+    }
+}
+
+template <typename Out>
+void reduceArray(Out* out, vtkDataArray* in, vtkIdType begin, vtkIdType count, StressEnvelope::Reduction reduction,
+                 bool first)
+{
+    if (vtkFloatArray* values = vtkFloatArray::SafeDownCast(in)) {
+        reduceRange(out + begin, values->GetPointer(begin), count, reduction, first);
+    } else {
+        reduceRange(out + begin, vtkDoubleArray::SafeDownCast(in)->GetPointer(begin), count, reduction, first);
+    }
+}
+
+// float / double 以外の型の応力は double に変換して扱う
+vtkSmartPointer<vtkDataArray> toContiguousValues(vtkDataArray* stress)
+{
+    if (vtkFloatArray::SafeDownCast(stress) || vtkDoubleArray::SafeDownCast(stress)) {
+        return stress;
+    }
+    vtkSmartPointer<vtkDoubleArray> values = vtkSmartPointer<vtkDoubleArray>::New();
+    values->DeepCopy(stress);
+    return values;
+}
+
+// grid が mesh と同じメッシュか（点数・セル数だけでなく、セルの種類と接続の大きさ、点座標も比べる）
+// 座標は float / double で書き出された同じメッシュを区別しないよう、点ごとの座標の大きさに対する相対誤差で比べる
+// （共有されたデータセットの境界を計算して書き換えないよう、GetBounds などは使わない）
+bool sharesMesh(vtkUnstructuredGrid* mesh, vtkUnstructuredGrid* grid)
+{
+    if (grid == mesh) {
+        return true;
+    }
+    const vtkIdType pointCount = mesh->GetNumberOfPoints();
+    const vtkIdType cellCount = mesh->GetNumberOfCells();
+    if (grid->GetNumberOfPoints() != pointCount || grid->GetNumberOfCells() != cellCount) {
+        return false;
+    }
+
+    vtkCellArray* meshCells = mesh->GetCells();
+    vtkCellArray* gridCells = grid->GetCells();
+    if ((meshCells ? meshCells->GetNumberOfConnectivityIds() : 0)
+        != (gridCells ? gridCells->GetNumberOfConnectivityIds() : 0)) {
+        return false;
+    }
+    vtkUnsignedCharArray* meshTypes = mesh->GetCellTypesArray();
+    vtkUnsignedCharArray* gridTypes = grid->GetCellTypesArray();
+    if (cellCount > 0 && (!meshTypes || !gridTypes
+                          || std::memcmp(meshTypes->GetPointer(0), gridTypes->GetPointer(0),
+                                         static_cast<size_t>(cellCount)) != 0)) {
+        return false;
+    }
+
+    if (pointCount == 0 || mesh->GetPoints() == grid->GetPoints()) {
+        return true;
+    }
+    vtkDataArray* meshPoints = mesh->GetPoints()->GetData();
+    vtkDataArray* gridPoints = grid->GetPoints()->GetData();
+    for (vtkIdType i = 0; i < pointCount; ++i) {
+        double a[3];
+        double b[3];
+        meshPoints->GetTuple(i, a);
+        gridPoints->GetTuple(i, b);
+        const double tolerance = 1e-6 * std::max({std::abs(a[0]), std::abs(a[1]), std::abs(a[2])});
+        if (std::abs(a[0] - b[0]) > tolerance || std::abs(a[1] - b[1]) > tolerance
+            || std::abs(a[2] - b[2]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool StressEnvelope::parseReduction(const std::string& name, Reduction& reduction)
+{
+    if (name == "max") {
+        reduction = Reduction::Maximum;
+    } else if (name == "absmax") {
+        reduction = Reduction::MaximumAbsolute;
+    } else if (name == "min") {
+        reduction = Reduction::Minimum;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string StressEnvelope::getReductionName(Reduction reduction)
+{
+    switch (reduction) {
+    case Reduction::MaximumAbsolute:
+        return "absmax";
+    case Reduction::Minimum:
+        return "min";
+    case Reduction::Maximum:
+    default:
+        return "max";
+    }
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> StressEnvelope::compute(const std::vector<vtkUnstructuredGrid*>& cases,
+                                                             Reduction reduction, const std::string& envelopeLabel,
+                                                             ProcessControl* control)
+{
+    Profiler::Scope profile("Compute stress envelope");
+    if (cases.empty() || !cases.front()) {
+        return nullptr;
+    }
+    vtkUnstructuredGrid* mesh = cases.front();
+    const vtkIdType pointCount = mesh->GetNumberOfPoints();
+
+    bool doublePrecision = false;
+    std::vector<vtkSmartPointer<vtkDataArray>> inputs;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        vtkUnstructuredGrid* grid = cases[i];
+        if (!grid || !sharesMesh(mesh, grid)) {
+            std::cerr << "Error: Load case " << i << " does not share the mesh of the first load case." << std::endl;
+            return nullptr;
+        }
+        vtkDataArray* stress = grid->GetPointData()->GetScalars();
+        if (!stress || stress->GetNumberOfComponents() != 1 || stress->GetNumberOfTuples() != pointCount) {
+            std::cerr << "Error: Load case " << i << " has no scalar point stress." << std::endl;
+            return nullptr;
+        }
+        inputs.push_back(toContiguousValues(stress));
+        doublePrecision = doublePrecision || vtkDoubleArray::SafeDownCast(inputs.back()) != nullptr;
+    }
+
+    // 入力がすべて float であれば float、そうでなければ double で集約する
+    vtkSmartPointer<vtkDataArray> envelope;
+    if (doublePrecision) {
+        envelope = vtkSmartPointer<vtkDoubleArray>::New();
+    } else {
+        envelope = vtkSmartPointer<vtkFloatArray>::New();
+    }
+    envelope->SetName(envelopeLabel.c_str());
+    envelope->SetNumberOfComponents(1);
+    envelope->SetNumberOfTuples(pointCount);
+    float* floatOut = doublePrecision ? nullptr : vtkFloatArray::SafeDownCast(envelope)->GetPointer(0);
+    double* doubleOut = doublePrecision ? vtkDoubleArray::SafeDownCast(envelope)->GetPointer(0) : nullptr;
+
+    // 点の範囲ごとに全ケースを順に集約する（出力の範囲はキャッシュに載ったまま各ケースを読む）
+    const size_t chunkCount = static_cast<size_t>((pointCount + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    ParallelUtility::parallelFor(chunkCount, [&](size_t chunk) {
+        if (control && control->isCancelled()) {
+            return;
+        }
+        const vtkIdType begin = static_cast<vtkIdType>(chunk) * CHUNK_SIZE;
+        const vtkIdType count = std::min(CHUNK_SIZE, pointCount - begin);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (doublePrecision) {
+                reduceArray(doubleOut, inputs[i], begin, count, reduction, i == 0);
+            } else {
+                reduceArray(floatOut, inputs[i], begin, count, reduction, i == 0);
+            }
+        }
+    });
+    if (control && control->isCancelled()) {
+        return nullptr;
+    }
+
+    // 点・セルは最初のケースと共有し、包絡値のみを持つデータセットにする
+    vtkSmartPointer<vtkUnstructuredGrid> result = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    result->CopyStructure(mesh);
+    result->GetPointData()->AddArray(envelope);
+    result->GetPointData()->SetActiveScalars(envelopeLabel.c_str());
+    profile.addCount("points", pointCount);
+    profile.addCount("load cases", static_cast<std::int64_t>(cases.size()));
+    return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+class ProcessControl;
+
+// 同じメッシュに対する複数の荷重ケースの応力から、点ごとの包絡値を求める関数
+// 各ケースのアクティブスカラー（1成分の応力）を点ごとに集約し、
+// 形状は最初のケースと共有した包絡値のデータセットを作成する
+class StressEnvelope {
+public:
+    enum class Reduction {
+        Maximum,         // 最大値（ミーゼス応力など非負の量）
+        MaximumAbsolute, // 絶対値の最大値（主応力など符号を持つ量）
+        Minimum          // 最小値（圧縮側の評価など）
+    };
+
+    // "max" / "absmax" / "min" を解釈する（不明な名前の場合は false）
+    static bool parseReduction(const std::string& name, Reduction& reduction);
+    static std::string getReductionName(Reduction reduction);
+
+    // cases の応力を集約した点配列 envelopeLabel をアクティブスカラーとして持つデータセットを返す
+    // メッシュ（点数・セル数・セルの種類・点座標）が一致しない場合や1成分の応力を持たない場合、キャンセル時は nullptr
+    static vtkSmartPointer<vtkUnstructuredGrid> compute(const std::vector<vtkUnstructuredGrid*>& cases,
+                                                        Reduction reduction, const std::string& envelopeLabel,
+                                                        ProcessControl* control = nullptr);
+};
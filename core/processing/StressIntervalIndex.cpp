@@ -0,0 +1,107 @@
+#include "StressIntervalIndex.h"
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// double から float への丸めで区間が狭くならないよう、下限は切り下げ・上限は切り上げる
+float roundDown(double value) {
+    float f = static_cast<float>(value);
+    if (static_cast<double>(f) > value) {
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    }
+    return f;
+}
+
+float roundUp(double value) {
+    float f = static_cast<float>(value);
+    if (static_cast<double>(f) < value) {
+        f = std::nextafter(f, std::numeric_limits<float>::infinity());
+    }
+    return f;
+}
+
+template <typename Getter>
+void buildImpl(vtkCellArray* cells, Getter getValue, std::vector<float>& cellMin, std::vector<float>& cellMax)
+{
+    auto iter = vtk::TakeSmartPointer(cells->NewIterator());
+    for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal(); iter->GoToNextCell()) {
+        vtkIdType npts = 0;
+        const vtkIdType* pts = nullptr;
+        iter->GetCurrentCell(npts, pts);
+        const vtkIdType cellId = iter->GetCurrentCellId();
+        if (npts == 0) {
+            // 点を持たないセルはどのバンドにも属さない空区間とする
+            cellMin[cellId] = std::numeric_limits<float>::infinity();
+            cellMax[cellId] = -std::numeric_limits<float>::infinity();
+            continue;
+        }
+
+        double minValue = getValue(pts[0]);
+        double maxValue = minValue;
+        for (vtkIdType i = 1; i < npts; ++i) {
+            double v = getValue(pts[i]);
+            minValue = std::min(minValue, v);
+            maxValue = std::max(maxValue, v);
+        }
+        cellMin[cellId] = roundDown(minValue);
+        cellMax[cellId] = roundUp(maxValue);
+    }
+}
+
+} // namespace
+
+bool StressIntervalIndex::build(vtkUnstructuredGrid* grid, const std::string& stressLabel)
+{
+    clear();
+    if (!grid) return false;
+
+    vtkDataArray* stressArray = grid->GetPointData()->GetArray(stressLabel.c_str());
+    if (!stressArray) {
+        std::cerr << "Error: Stress array not found: " << stressLabel << std::endl;
+        return false;
+    }
+
+    const vtkIdType numCells = grid->GetNumberOfCells();
+    cellMin.resize(numCells);
+    cellMax.resize(numCells);
+
+    vtkCellArray* cells = grid->GetCells();
+    if (auto floatArray = vtkFloatArray::FastDownCast(stressArray)) {
+        const float* values = floatArray->GetPointer(0);
+        buildImpl(cells, [values](vtkIdType id) { return static_cast<double>(values[id]); }, cellMin, cellMax);
+    } else if (auto doubleArray = vtkDoubleArray::FastDownCast(stressArray)) {
+        const double* values = doubleArray->GetPointer(0);
+        buildImpl(cells, [values](vtkIdType id) { return values[id]; }, cellMin, cellMax);
+    } else {
+        buildImpl(cells, [stressArray](vtkIdType id) { return stressArray->GetComponent(id, 0); }, cellMin, cellMax);
+    }
+
+    std::cout << "Built stress interval index for " << numCells << " cells" << std::endl;
+    return true;
+}
+
+void StressIntervalIndex::assign(std::vector<float> cellMin, std::vector<float> cellMax)
+{
+    this->cellMin = std::move(cellMin);
+    this->cellMax = std::move(cellMax);
+}
+
+void StressIntervalIndex::clear()
+{
+    cellMin.clear();
+    cellMin.shrink_to_fit();
+    cellMax.clear();
+    cellMax.shrink_to_fit();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <vtkType.h>
+
+class vtkUnstructuredGrid;
+
+// セルごとの応力の最小値/最大値（区間）を保持するインデックス
+// データ読み込み時に一度だけ構築し、バンド分割のたびに
+// 接続情報と応力配列を読み直さずにセルを分類できるようにする
+class StressIntervalIndex {
+public:
+    // グリッドの全セルを走査して区間を構築する
+    bool build(vtkUnstructuredGrid* grid, const std::string& stressLabel);
+    // 保存しておいた区間（build の結果）をそのまま設定する
+    void assign(std::vector<float> cellMin, std::vector<float> cellMax);
+    void clear();
+
+    bool isBuilt() const { return !cellMin.empty(); }
+    vtkIdType getCellCount() const { return static_cast<vtkIdType>(cellMin.size()); }
+
+    // 区間は float に丸める際に外側へ広げてあるため、
+    // 「区間が範囲内に収まる」と判定されたセルは実際にも範囲内にある
+    float getCellMin(vtkIdType cellId) const { return cellMin[cellId]; }
+    float getCellMax(vtkIdType cellId) const { return cellMax[cellId]; }
+    const std::vector<float>& getCellMinValues() const { return cellMin; }
+    const std::vector<float>& getCellMaxValues() const { return cellMax; }
+
+private:
+    std::vector<float> cellMin;
+    std::vector<float> cellMax;
+};
@@ -1,31 +1,96 @@
 #include "VtkProcessor.h"
+#include "StressBandDivider.h"
+#include "DatasetCache.h"
+#include "VtuBinaryCache.h"
+#include "AppendedVtuReader.h"
+#include "Workspace.h"
 #include "../../utils/tempPathUtility.h"
+#include "../../utils/parallelUtility.h"
+#include "../../utils/profiler.h"
+#include <vtkAppendPolyData.h>
+#include <vtkCompositeDataGeometryFilter.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataArraySelection.h>
+#include <vtkInformation.h>
+#include <vtkInformationIntegerKey.h>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <QColor>
+#include <QXmlStreamReader>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <limits>
 #include <vector>
 
+namespace {
+// 読み込んだデータセットに、読み込み方法（VtkProcessor::LoadSource）を記録するキー
+// DatasetCache で共有されたデータセットからも、ファイルを開き直さずに読み込み方法がわかる
+vtkInformationIntegerKey* loadSourceKey()
+{
+    static vtkInformationIntegerKey* key = vtkInformationIntegerKey::MakeKey("LOAD_SOURCE", "VtkProcessor");
+    return key;
+}
+} // namespace
+
 VtkProcessor::VtkProcessor(const std::string& vtuFileName): vtuFileName(vtuFileName) {
     // renderWindow->AddRenderer(renderer);
     // renderWindowInteractor->SetRenderWindow(renderWindow);
 }
 
+void VtkProcessor::setLoadSource(vtkDataObject* data, LoadSource source) {
+    data->GetInformation()->Set(loadSourceKey(), static_cast<int>(source));
+}
+
+VtkProcessor::LoadSource VtkProcessor::getLoadSource(vtkDataObject* data) {
+    vtkInformation* information = data ? data->GetInformation() : nullptr;
+    if (!information || !information->Has(loadSourceKey())) {
+        return LoadSource::Parsed;
+    }
+    return static_cast<LoadSource>(information->Get(loadSourceKey()));
+}
+
 void VtkProcessor::showInfo(){
     std::cout << "VTK file: " << vtuFileName << std::endl;
 }
 
 std::string VtkProcessor::detectStressLabel() {
-    if (!vtuData) {
+    if (pieces.empty()) {
         std::cerr << "Error: No VTU data available for label detection." << std::endl;
         return "";
     }
 
-    vtkPointData* pointData = vtuData->GetPointData();
+    vtkPointData* pointData = pieces.front().grid->GetPointData();
     int numArrays = pointData->GetNumberOfArrays();
+    std::vector<std::string> arrayNames;
+    for (int i = 0; i < numArrays; ++i) {
+        const char* arrayName = pointData->GetArrayName(i);
+        arrayNames.push_back(arrayName ? std::string(arrayName) : std::string());
+    }
+    return detectStressLabel(arrayNames);
+}
+
+std::string VtkProcessor::detectStressLabel(const std::vector<std::string>& arrayNames) {
+    const std::string label = findStressLabel(arrayNames);
+    if (!label.empty()) {
+        return label;
+    }
+
+    // デフォルトとして最初のスカラー配列を使用（応力でない可能性があるため警告する）
+    if (!arrayNames.empty() && !arrayNames[0].empty()) {
+        std::cout << "Warning: No stress array found, using the first array as stress label: " << arrayNames[0]
+                  << std::endl;
+        return arrayNames[0];
+    }
     
+    std::cerr << "Error: No suitable stress label found." << std::endl;
+    return "";
+}
+
+std::string VtkProcessor::findStressLabel(const std::vector<std::string>& arrayNames) {
     // 候補となるラベル名
     std::vector<std::string> candidateLabels = {
         "von Mises Stress",
@@ -36,118 +101,779 @@ std::string VtkProcessor::detectStressLabel() {
     
     // 利用可能な配列名をチェック
     for (const auto& candidate : candidateLabels) {
-        for (int i = 0; i < numArrays; ++i) {
-            const char* arrayName = pointData->GetArrayName(i);
-            if (arrayName && std::string(arrayName) == candidate) {
+        for (const auto& name : arrayNames) {
+            if (name == candidate) {
                 std::cout << "Detected stress label: " << candidate << std::endl;
                 return candidate;
             }
         }
     }
     
-    // 完全一致が見つからない場合、部分一致を試す
-    for (int i = 0; i < numArrays; ++i) {
-        const char* arrayName = pointData->GetArrayName(i);
-        if (arrayName) {
-            std::string name(arrayName);
-            if (name.find("von") != std::string::npos || 
-                name.find("Mises") != std::string::npos ||
-                name.find("stress") != std::string::npos ||
-                name.find("Stress") != std::string::npos) {
-                std::cout << "Detected stress label (partial match): " << name << std::endl;
-                return name;
-            }
+    // 完全一致が見つからない場合、部分一致を試す（ミーゼス応力の名前を優先する）
+    for (const auto& name : arrayNames) {
+        if (name.find("von") != std::string::npos || name.find("Mises") != std::string::npos) {
+            std::cout << "Detected stress label (partial match): " << name << std::endl;
+            return name;
         }
     }
-    
-    // デフォルトとして最初のスカラー配列を使用
-    if (numArrays > 0) {
-        const char* defaultName = pointData->GetArrayName(0);
-        if (defaultName) {
-            std::cout << "Using default array as stress label: " << defaultName << std::endl;
-            return std::string(defaultName);
+    // 成分ごとの配列（Sxx など）は1成分だけではバンド分割に使えないため除く
+    for (const auto& name : arrayNames) {
+        if ((name.find("stress") != std::string::npos || name.find("Stress") != std::string::npos)
+            && !DerivedStress::isComponentArrayName(name)) {
+            std::cout << "Detected stress label (partial match): " << name << std::endl;
+            return name;
         }
     }
-    
-    std::cerr << "Error: No suitable stress label found." << std::endl;
     return "";
 }
 
-bool VtkProcessor:: LoadAndPrepareData() {
-    // VTKファイルの読み込み
+DerivedStress::Selection VtkProcessor::selectStressArrays(const std::vector<std::string>& arrayNames,
+                                                          const DerivedStress::Settings& settings) {
+    DerivedStress::Selection selection;
+    if (settings.quantity == DerivedStress::Quantity::Auto) {
+        // スカラーの応力配列を優先する（6 / 9成分のテンソルであった場合は読み込み後にミーゼス応力を求める）
+        std::string label = findStressLabel(arrayNames);
+        if (label.empty()) {
+            selection.arrayNames = DerivedStress::findComponentArrays(arrayNames);
+            if (!selection.empty()) {
+                return selection;
+            }
+            label = detectStressLabel(arrayNames);
+        }
+        if (!label.empty()) {
+            selection.arrayNames = {label};
+        }
+        return selection;
+    }
+
+    // 指定された応力は成分配列、なければ応力のテンソル配列から求める
+    selection.arrayNames = DerivedStress::findComponentArrays(arrayNames);
+    if (selection.empty()) {
+        const std::string label = findStressLabel(arrayNames);
+        if (label.empty()) {
+            std::cerr << "Error: No stress tensor found to derive "
+                      << DerivedStress::getQuantityName(settings.quantity) << "." << std::endl;
+            return selection;
+        }
+        selection.arrayNames = {label};
+    }
+    return selection;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> VtkProcessor::loadVtuFile(const std::string& fileName, bool selective,
+                                                               const DerivedStress::Settings& stressSettings,
+                                                               ProcessControl* control) {
+    // 以前に書き出したバイナリキャッシュがあれば、XMLを解析せずにマップして使う
+    if (selective) {
+        std::string cachedLabel;
+        vtkSmartPointer<vtkUnstructuredGrid> cachedGrid =
+            VtuBinaryCache::read(fileName, cachedLabel, stressSettings.getKey());
+        if (cachedGrid) {
+            setLoadSource(cachedGrid, LoadSource::BinaryCache);
+            return cachedGrid;
+        }
+
+        // appended 形式であれば、ファイルをマップして圧縮なしの配列はそのまま参照し、
+        // 圧縮された配列はブロックを並列に展開する
+        AppendedVtuReader appendedReader;
+        if (appendedReader.open(fileName)) {
+            const DerivedStress::Selection appendedSelection =
+                selectStressArrays(appendedReader.getPointArrayNames(), stressSettings);
+            if (appendedSelection.empty()) {
+                return nullptr;
+            }
+            vtkSmartPointer<vtkUnstructuredGrid> appendedGrid = appendedReader.read(appendedSelection.arrayNames, control);
+            if (control && control->isCancelled()) {
+                return nullptr;
+            }
+            if (appendedGrid) {
+                const std::string appendedLabel =
+                    DerivedStress::apply(appendedGrid, appendedSelection, stressSettings, true, control);
+                if (appendedLabel.empty()) {
+                    return nullptr;
+                }
+                // テンソルから求めた応力はファイルにないため、バイナリキャッシュに書き出す
+                const bool rawStress = std::find(appendedSelection.arrayNames.begin(), appendedSelection.arrayNames.end(),
+                                                 appendedLabel) != appendedSelection.arrayNames.end();
+                if (!appendedReader.isCompressed() && rawStress) {
+                    setLoadSource(appendedGrid, LoadSource::RawAppended);
+                }
+                return appendedGrid;
+            }
+        }
+    }
+
+    Profiler::Scope profile("Read VTU");
+    std::error_code sizeError;
+    profile.addCount("bytes", static_cast<std::int64_t>(std::filesystem::file_size(fileName, sizeError)));
+
     vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    reader->SetFileName(vtuFileName.c_str());
+    reader->SetFileName(fileName.c_str());
+
+    DerivedStress::Selection selection;
+    if (selective) {
+        // ヘッダーのみを読み込んで配列名を取得し、ストレス配列（またはテンソル・成分配列）だけを読み込み対象にする
+        reader->UpdateInformation();
+        std::vector<std::string> arrayNames;
+        for (int i = 0; i < reader->GetNumberOfPointArrays(); ++i) {
+            const char* arrayName = reader->GetPointArrayName(i);
+            arrayNames.push_back(arrayName ? std::string(arrayName) : std::string());
+        }
+        selection = selectStressArrays(arrayNames, stressSettings);
+        if (selection.empty()) {
+            return nullptr;
+        }
+        reader->GetPointDataArraySelection()->DisableAllArrays();
+        for (const auto& arrayName : selection.arrayNames) {
+            reader->GetPointDataArraySelection()->EnableArray(arrayName.c_str());
+        }
+        reader->GetCellDataArraySelection()->DisableAllArrays();
+        std::cout << "Loading only " << selection.arrayNames.size() << " point array(s) starting with '"
+                  << selection.arrayNames.front() << "' of " << arrayNames.size() << " arrays" << std::endl;
+    }
+
+    if (control) {
+        control->observe(reader);
+    }
     reader->Update();
-    // データセットを取得
-    vtuData = reader->GetOutput();
-    if (!vtuData) {
+
+    // 中断された読み込み結果はキャッシュに残さない
+    if (control && control->isCancelled()) {
+        return nullptr;
+    }
+
+    // 読み込んだデータセットを取得
+    vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid = reader->GetOutput();
+    if (!unstructuredGrid || unstructuredGrid->GetNumberOfPoints() == 0) {
         std::cerr << "Error: Unable to read the VTK file." << std::endl;
+        return nullptr;
+    }
+
+    vtkPointData* pointData = unstructuredGrid->GetPointData();
+    if (!selective) {
+        std::vector<std::string> arrayNames;
+        for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+            const char* arrayName = pointData->GetArrayName(i);
+            arrayNames.push_back(arrayName ? std::string(arrayName) : std::string());
+        }
+        selection = selectStressArrays(arrayNames, stressSettings);
+        if (selection.empty()) {
+            return nullptr;
+        }
+    }
+
+    // データセットは表示と処理で共有されるため、アクティブスカラーは読み込み時に一度だけ設定する
+    // テンソルのみの場合はここで応力を求める（全配列を読み込む場合はテンソルも残す）
+    if (DerivedStress::apply(unstructuredGrid, selection, stressSettings, selective, control).empty()) {
+        return nullptr;
+    }
+    profile.addCount("cells", unstructuredGrid->GetNumberOfCells());
+    profile.addCount("points", unstructuredGrid->GetNumberOfPoints());
+    return unstructuredGrid;
+}
+
+bool VtkProcessor::isPartitionedFile(const std::string& fileName) {
+    std::string extension = std::filesystem::path(fileName).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".pvtu";
+}
+
+std::vector<std::string> VtkProcessor::getPieceFileNames(const std::string& fileName) {
+    if (!isPartitionedFile(fileName)) {
+        return {fileName};
+    }
+
+    std::ifstream stream(fileName, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Error: Unable to open PVTU file: " << fileName << std::endl;
+        return {};
+    }
+    const std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    // ピースのパスは .pvtu のあるディレクトリからの相対パス
+    const std::filesystem::path baseDir = std::filesystem::path(fileName).parent_path();
+    std::vector<std::string> pieceFiles;
+    QXmlStreamReader reader(QByteArray::fromStdString(content));
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        if (reader.name() == QLatin1String("PUnstructuredGrid")
+            && reader.attributes().value("GhostLevel").toInt() > 0) {
+            // 選択読み込みではセルデータを読まないため、ゴーストセルを取り除けない
+            std::cerr << "Error: PVTU files with ghost cells are not supported: " << fileName << std::endl;
+            return {};
+        }
+        if (reader.name() == QLatin1String("Piece")) {
+            const std::filesystem::path source = reader.attributes().value("Source").toString().toStdString();
+            pieceFiles.push_back((source.is_absolute() ? source : baseDir / source).string());
+        }
+    }
+    if (reader.hasError() || pieceFiles.empty()) {
+        std::cerr << "Error: Unable to read the piece list of PVTU file: " << fileName << std::endl;
+        return {};
+    }
+    return pieceFiles;
+}
+
+std::string VtkProcessor::getDatasetStamp(const std::string& fileName) {
+    std::vector<std::string> files = {fileName};
+    if (isPartitionedFile(fileName)) {
+        const std::vector<std::string> pieceFiles = getPieceFileNames(fileName);
+        files.insert(files.end(), pieceFiles.begin(), pieceFiles.end());
+    }
+    std::ostringstream stamp;
+    for (const auto& file : files) {
+        std::error_code ec;
+        const auto fileSize = std::filesystem::file_size(file, ec);
+        if (ec) return "";
+        const auto fileTime = std::filesystem::last_write_time(file, ec);
+        if (ec) return "";
+        stamp << fileSize << ":" << fileTime.time_since_epoch().count() << ";";
+    }
+    return stamp.str();
+}
+
+vtkSmartPointer<vtkMultiBlockDataSet> VtkProcessor::loadPvtuFile(const std::string& fileName, bool selective,
+                                                                 const DerivedStress::Settings& stressSettings,
+                                                                 ProcessControl* control) {
+    Profiler::Scope profile("Read PVTU");
+    const std::vector<std::string> pieceFiles = getPieceFileNames(fileName);
+    if (pieceFiles.empty()) {
+        return nullptr;
+    }
+
+    // ピースは独立したファイルなので並列に読み込む
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid>> grids(pieceFiles.size());
+    ParallelUtility::parallelFor(pieceFiles.size(), [&](size_t i) {
+        if (control && control->isCancelled()) {
+            return;
+        }
+        grids[i] = loadVtuFile(pieceFiles[i], selective, stressSettings, control);
+    });
+    if (control && control->isCancelled()) {
+        return nullptr;
+    }
+
+    vtkSmartPointer<vtkMultiBlockDataSet> blocks = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    blocks->SetNumberOfBlocks(static_cast<unsigned int>(pieceFiles.size()));
+    std::string stressLabel;
+    for (size_t i = 0; i < pieceFiles.size(); ++i) {
+        if (!grids[i]) {
+            std::cerr << "Error: Unable to read PVTU piece: " << pieceFiles[i] << std::endl;
+            return nullptr;
+        }
+        vtkDataArray* scalars = grids[i]->GetPointData()->GetScalars();
+        const std::string pieceLabel = (scalars && scalars->GetName()) ? std::string(scalars->GetName()) : std::string();
+        if (i == 0) {
+            stressLabel = pieceLabel;
+        } else if (pieceLabel != stressLabel) {
+            std::cerr << "Error: PVTU pieces use different stress arrays: '" << stressLabel << "' and '"
+                      << pieceLabel << "'" << std::endl;
+            return nullptr;
+        }
+        const unsigned int block = static_cast<unsigned int>(i);
+        blocks->SetBlock(block, grids[i]);
+        blocks->GetMetaData(block)->Set(vtkCompositeDataSet::NAME(), pieceFiles[i].c_str());
+        profile.addCount("cells", grids[i]->GetNumberOfCells());
+    }
+    profile.addCount("pieces", static_cast<std::int64_t>(pieceFiles.size()));
+    std::cout << "Loaded " << pieceFiles.size() << " PVTU pieces: " << fileName << std::endl;
+    return blocks;
+}
+
+std::vector<VtkProcessor::DataPiece> VtkProcessor::readVtuPieces(const std::string& fileName, std::string& stressLabel) {
+    // 同じファイル・同じ読み込み方法であればキャッシュ済みのデータセットを共有する
+    const bool selective = selectiveArrayLoading;
+    const DerivedStress::Settings stressSettings = derivedStress;
+    ProcessControl* control = processControl;
+    const std::string variant = getLoadVariant();
+    std::vector<DataPiece> result;
+    if (isPartitionedFile(fileName)) {
+        // ピースのみが更新された場合も読み込み直すよう、全ピースのサイズと更新日時を区別に含める
+        std::vector<DatasetCache::ScalarRange> ranges;
+        vtkSmartPointer<vtkDataObject> data = DatasetCache::instance().getOrLoad(
+            fileName, variant + "|" + getDatasetStamp(fileName),
+            [&fileName, selective, stressSettings, control]() -> vtkSmartPointer<vtkDataObject> {
+                return loadPvtuFile(fileName, selective, stressSettings, control);
+            }, &ranges, control);
+        vtkMultiBlockDataSet* blocks = vtkMultiBlockDataSet::SafeDownCast(data);
+        if (!blocks || ranges.size() != blocks->GetNumberOfBlocks()) {
+            return {};
+        }
+        for (unsigned int i = 0; i < blocks->GetNumberOfBlocks(); ++i) {
+            DataPiece piece;
+            piece.fileName = blocks->GetMetaData(i)->Get(vtkCompositeDataSet::NAME());
+            piece.grid = vtkUnstructuredGrid::SafeDownCast(blocks->GetBlock(i));
+            piece.loadSource = getLoadSource(piece.grid);
+            piece.scalarRange[0] = ranges[i][0];
+            piece.scalarRange[1] = ranges[i][1];
+            result.push_back(std::move(piece));
+        }
+    } else {
+        DataPiece piece;
+        piece.fileName = fileName;
+        DatasetCache::ScalarRange range = {0.0, 0.0};
+        piece.grid = DatasetCache::instance().getUnstructuredGrid(
+            fileName, variant,
+            [&fileName, selective, stressSettings, control]() {
+                return loadVtuFile(fileName, selective, stressSettings, control);
+            }, &range, control);
+        if (!piece.grid) {
+            return {};
+        }
+        piece.loadSource = getLoadSource(piece.grid);
+        piece.scalarRange[0] = range[0];
+        piece.scalarRange[1] = range[1];
+        result.push_back(std::move(piece));
+    }
+
+    vtkDataArray* scalars = result.front().grid->GetPointData()->GetScalars();
+    stressLabel = (scalars && scalars->GetName()) ? std::string(scalars->GetName()) : std::string();
+    if (stressLabel.empty()) {
+        return {};
+    }
+    return result;
+}
+
+std::vector<VtkProcessor::DataPiece> VtkProcessor::readStressPieces(const std::string& fileName,
+                                                                   std::string& stressLabel) {
+    if (loadCaseFiles.empty()) {
+        return readVtuPieces(fileName, stressLabel);
+    }
+
+    // 包絡値は表示用と処理用で共有するよう、全ケースのファイルと更新日時を区別に含めてキャッシュする
+    std::ostringstream variant;
+    variant << "envelope|" << getLoadVariant() << "|"
+            << StressEnvelope::getReductionName(envelopeReduction) << "|" << getDatasetStamp(fileName);
+    for (const auto& caseFile : loadCaseFiles) {
+        variant << "|" << caseFile << "|" << getDatasetStamp(caseFile);
+    }
+    std::vector<DatasetCache::ScalarRange> ranges;
+    vtkSmartPointer<vtkDataObject> data = DatasetCache::instance().getOrLoad(
+        fileName, variant.str(), [this, &fileName]() -> vtkSmartPointer<vtkDataObject> {
+            return loadEnvelope(fileName);
+        }, &ranges, processControl);
+    vtkMultiBlockDataSet* blocks = vtkMultiBlockDataSet::SafeDownCast(data);
+    if (!blocks || blocks->GetNumberOfBlocks() == 0 || ranges.size() != blocks->GetNumberOfBlocks()) {
+        return {};
+    }
+
+    std::vector<DataPiece> result;
+    for (unsigned int i = 0; i < blocks->GetNumberOfBlocks(); ++i) {
+        DataPiece piece;
+        piece.fileName = blocks->GetMetaData(i)->Get(vtkCompositeDataSet::NAME());
+        piece.grid = vtkUnstructuredGrid::SafeDownCast(blocks->GetBlock(i));
+        piece.cacheable = false;
+        piece.scalarRange[0] = ranges[i][0];
+        piece.scalarRange[1] = ranges[i][1];
+        result.push_back(std::move(piece));
+    }
+    vtkDataArray* scalars = result.front().grid->GetPointData()->GetScalars();
+    stressLabel = (scalars && scalars->GetName()) ? std::string(scalars->GetName()) : std::string();
+    return result;
+}
+
+vtkSmartPointer<vtkMultiBlockDataSet> VtkProcessor::loadEnvelope(const std::string& fileName) {
+    Profiler::Scope profile("Load stress envelope");
+    std::vector<std::string> caseFiles = {fileName};
+    caseFiles.insert(caseFiles.end(), loadCaseFiles.begin(), loadCaseFiles.end());
+
+    // 各荷重ケースは独立したファイルなので並列に読み込む
+    std::vector<std::vector<DataPiece>> cases(caseFiles.size());
+    std::vector<std::string> caseLabels(caseFiles.size());
+    ParallelUtility::parallelFor(caseFiles.size(), [&](size_t i) {
+        if (processControl && processControl->isCancelled()) {
+            return;
+        }
+        cases[i] = readVtuPieces(caseFiles[i], caseLabels[i]);
+    });
+    if (processControl && processControl->isCancelled()) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < caseFiles.size(); ++i) {
+        if (cases[i].empty()) {
+            std::cerr << "Error: Unable to read load case: " << caseFiles[i] << std::endl;
+            return nullptr;
+        }
+        if (cases[i].size() != cases.front().size()) {
+            std::cerr << "Error: Load case has a different number of pieces: " << caseFiles[i] << std::endl;
+            return nullptr;
+        }
+        // 異なる量（ミーゼス応力と主応力など）の包絡値は意味を持たないため、同じ配列のみを集約する
+        if (caseLabels[i] != caseLabels.front()) {
+            std::cerr << "Error: Load case uses stress array '" << caseLabels[i] << "' instead of '"
+                      << caseLabels.front() << "': " << caseFiles[i] << std::endl;
+            return nullptr;
+        }
+    }
+
+    // ピースごとに全ケースの応力を点ごとに集約する（形状は最初のケースと共有）
+    const std::string envelopeLabel =
+        caseLabels.front() + " (" + StressEnvelope::getReductionName(envelopeReduction) + " envelope)";
+    vtkSmartPointer<vtkMultiBlockDataSet> blocks = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    blocks->SetNumberOfBlocks(static_cast<unsigned int>(cases.front().size()));
+    for (size_t p = 0; p < cases.front().size(); ++p) {
+        std::vector<vtkUnstructuredGrid*> grids;
+        for (const auto& loadCase : cases) {
+            grids.push_back(loadCase[p].grid);
+        }
+        vtkSmartPointer<vtkUnstructuredGrid> envelope =
+            StressEnvelope::compute(grids, envelopeReduction, envelopeLabel, processControl);
+        if (!envelope) {
+            if (!(processControl && processControl->isCancelled())) {
+                std::cerr << "Error: Load cases do not share the mesh of: " << cases.front()[p].fileName << std::endl;
+            }
+            return nullptr;
+        }
+        const unsigned int block = static_cast<unsigned int>(p);
+        blocks->SetBlock(block, envelope);
+        blocks->GetMetaData(block)->Set(vtkCompositeDataSet::NAME(), cases.front()[p].fileName.c_str());
+        profile.addCount("points", envelope->GetNumberOfPoints());
+    }
+    profile.addCount("load cases", static_cast<std::int64_t>(caseFiles.size()));
+    std::cout << "Computed " << StressEnvelope::getReductionName(envelopeReduction) << " envelope of "
+              << caseFiles.size() << " load cases: " << fileName << std::endl;
+    return blocks;
+}
+
+void VtkProcessor::setLoadCaseFiles(const std::vector<std::string>& files, StressEnvelope::Reduction reduction) {
+    if (loadCaseFiles != files || envelopeReduction != reduction) {
+        loadCaseFiles = files;
+        envelopeReduction = reduction;
+        // 応力が変わるため、次回は再読み込みする
+        loadedFileName.clear();
+    }
+}
+
+std::string VtkProcessor::getLoadStamp() const {
+    std::string stamp = getDatasetStamp(vtuFileName);
+    if (stamp.empty() || loadCaseFiles.empty()) {
+        return stamp;
+    }
+    stamp += StressEnvelope::getReductionName(envelopeReduction) + ";";
+    for (const auto& caseFile : loadCaseFiles) {
+        const std::string caseStamp = getDatasetStamp(caseFile);
+        if (caseStamp.empty()) {
+            return "";
+        }
+        stamp += caseFile + "=" + caseStamp;
+    }
+    return stamp;
+}
+
+std::string VtkProcessor::getLoadVariant() const {
+    const std::string stressKey = derivedStress.getKey();
+    const std::string variant = selectiveArrayLoading ? "selective" : "all";
+    return stressKey.empty() ? variant : variant + "|" + stressKey;
+}
+
+void VtkProcessor::setDerivedStress(const DerivedStress::Settings& settings) {
+    if (derivedStress.getKey() != settings.getKey()) {
+        // 応力の配列が変わるため、次回は再読み込みする
+        loadedFileName.clear();
+    }
+    derivedStress = settings;
+}
+
+void VtkProcessor::setSelectiveArrayLoading(bool enabled) {
+    if (selectiveArrayLoading != enabled) {
+        selectiveArrayLoading = enabled;
+        // 読み込む配列が変わるため、次回は再読み込みする
+        loadedFileName.clear();
+    }
+}
+
+bool VtkProcessor::isLoadedFileCurrent() const {
+    if (pieces.empty() || loadedFileName.empty() || loadedFileName != vtuFileName) {
         return false;
     }
+    return getLoadStamp() == loadedFileStamp;
+}
 
-    // ストレスラベルを動的に検出
-    detectedStressLabel = detectStressLabel();
+vtkIdType VtkProcessor::getCellCount() const {
+    vtkIdType cellCount = 0;
+    for (const auto& piece : pieces) {
+        cellCount += piece.grid->GetNumberOfCells();
+    }
+    return cellCount;
+}
+
+bool VtkProcessor::preparePieceIndex(DataPiece& piece) {
+    // バイナリキャッシュにあれば読み込み、なければ構築する
+    // 選択読み込みのデータセットはキャッシュに書き出し、次回は読み込みとインデックス構築を省略する
+    // 包絡値のピースは元ファイルの内容と異なるため、キャッシュは使わずに毎回構築する
+    if (!piece.cacheable) {
+        Profiler::Scope indexProfile("Build stress interval index");
+        if (!piece.stressIndex.build(piece.grid, detectedStressLabel)) {
+            std::cerr << "Error: Failed to build stress interval index: " << piece.fileName << std::endl;
+            return false;
+        }
+        indexProfile.addCount("cells", piece.stressIndex.getCellCount());
+        return true;
+    }
+    if (selectiveArrayLoading
+        && VtuBinaryCache::readIndex(piece.fileName, piece.grid->GetNumberOfCells(), piece.stressIndex,
+                                     derivedStress.getKey())) {
+        return true;
+    }
+    {
+        Profiler::Scope indexProfile("Build stress interval index");
+        if (!piece.stressIndex.build(piece.grid, detectedStressLabel)) {
+            std::cerr << "Error: Failed to build stress interval index: " << piece.fileName << std::endl;
+            return false;
+        }
+        indexProfile.addCount("cells", piece.stressIndex.getCellCount());
+    }
+    if (!selectiveArrayLoading) {
+        return true;
+    }
+    // 圧縮なしの appended 形式は元ファイルから直接読み込めるため、インデックスのみを書き出す
+    switch (piece.loadSource) {
+    case LoadSource::Parsed:
+        VtuBinaryCache::write(piece.fileName, piece.grid, detectedStressLabel, piece.stressIndex,
+                              derivedStress.getKey());
+        break;
+    case LoadSource::RawAppended:
+        VtuBinaryCache::writeIndex(piece.fileName, detectedStressLabel, piece.stressIndex, derivedStress.getKey());
+        break;
+    case LoadSource::BinaryCache:
+        break;
+    }
+    return true;
+}
+
+bool VtkProcessor:: LoadAndPrepareData() {
+    Profiler::Scope profile("Load and prepare VTU");
+    // 同じファイルが読み込み済みで更新されていなければ、読み込みとインデックス構築を省略
+    if (isLoadedFileCurrent()) {
+        std::cout << "Reusing loaded VTK data: " << vtuFileName << std::endl;
+        return true;
+    }
+    loadedFileName.clear();
+    clearBandCache();
+    outerSurface = nullptr;
+
+    // VTKファイルの読み込み（ストレスラベルもここで検出）
+    std::string stressLabel;
+    pieces = readStressPieces(vtuFileName, stressLabel);
+    if (processControl) processControl->throwIfCancelled();
+    if (pieces.empty()) {
+        std::cerr << "Error: Unable to read the VTK file." << std::endl;
+        return false;
+    }
+
+    detectedStressLabel = stressLabel;
     if (detectedStressLabel.empty()) {
         std::cerr << "Error: Could not detect stress label." << std::endl;
         return false;
     }
 
-    vtkPointData* pointData = vtuData->GetPointData();
-    pointData->SetActiveScalars(detectedStressLabel.c_str());
-    vtuData->GetScalarRange(stressRange);
+    // 全体の応力範囲は各ピースの範囲から求める
+    stressRange[0] = std::numeric_limits<double>::max();
+    stressRange[1] = std::numeric_limits<double>::lowest();
+    for (const auto& piece : pieces) {
+        stressRange[0] = std::min(stressRange[0], piece.scalarRange[0]);
+        stressRange[1] = std::max(stressRange[1], piece.scalarRange[1]);
+    }
 
     minStress = stressRange[0];
     maxStress = stressRange[1];
+
+    // バンド分割で使うセルごとの応力区間をピースごとに並列に準備
+    std::vector<char> prepared(pieces.size(), 0);
+    ParallelUtility::parallelFor(pieces.size(), [&](size_t i) {
+        prepared[i] = preparePieceIndex(pieces[i]) ? 1 : 0;
+    });
+    if (std::find(prepared.begin(), prepared.end(), 0) != prepared.end()) {
+        pieces.clear();
+        return false;
+    }
+    profile.addCount("cells", getCellCount());
+    profile.addCount("pieces", static_cast<std::int64_t>(pieces.size()));
+
+    loadedFileStamp = getLoadStamp();
+    if (!loadedFileStamp.empty()) {
+        loadedFileName = vtuFileName;
+    }
     return true;
 }
 
 vtkSmartPointer<vtkPolyData> VtkProcessor::extractRegionInRange(double lowerBound, double upperBound){
-
-    vtkSmartPointer<vtkClipDataSet> clip_min = vtkSmartPointer<vtkClipDataSet>::New();
-    clip_min->SetInputData(vtuData);
-    clip_min->SetValue(lowerBound);
-    clip_min->SetInsideOut(false);  // min_val より大きい領域を保持
-    clip_min->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, detectedStressLabel.c_str());
-    clip_min->Update();
-
-    // 3. クリップフィルタ2: max_val 以下の領域を抽出
-    vtkSmartPointer<vtkClipDataSet> clip_max = vtkSmartPointer<vtkClipDataSet>::New();
-    clip_max->SetInputConnection(clip_min->GetOutputPort());
-    clip_max->SetValue(upperBound);
-    clip_max->SetInsideOut(true);  // max_val より小さい領域を保持
-    clip_max->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, detectedStressLabel.c_str());
-    clip_max->Update();
-
-    // 最終的な結果: min_val と max_val の間の値を持つ領域
-    vtkSmartPointer<vtkUnstructuredGrid> ug_range = clip_max->GetOutput();  
-    vtkSmartPointer<vtkGeometryFilter> geometry_filter = vtkSmartPointer<vtkGeometryFilter>::New();
-    geometry_filter->SetInputData(ug_range);    
-    geometry_filter->Update();
-    vtkSmartPointer<vtkPolyData> poly_data = geometry_filter->GetOutput();
-    
-    return poly_data;
-}   
+    // 最終的な結果: min_val と max_val の間の値を持つ領域（ピースごとに切り出して結合）
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid>> pieceRanges;
+    for (const auto& piece : pieces) {
+        pieceRanges.push_back(StressBandDivider::clipRange(piece.grid, detectedStressLabel, lowerBound, upperBound));
+    }
+    vtkSmartPointer<vtkUnstructuredGrid> ug_range = StressBandDivider::mergeGrids(pieceRanges);
+    return StressBandDivider::extractSurface(ug_range);
+}
 
 std::vector<vtkSmartPointer<vtkPolyData>> VtkProcessor::divideMesh() {
-    std::vector<vtkSmartPointer<vtkPolyData>> dividedPolyData;
+    Profiler::Scope profile("Divide mesh");
+    const int bandCount = isoSurfaceNum - 1;
+    std::vector<vtkSmartPointer<vtkPolyData>> dividedPolyData(std::max(bandCount, 0));
 
-    for (int i = 0; i < isoSurfaceNum - 1; ++i) {
-        double minValue = stressValues[i];
-        double maxValue = stressValues[i + 1];
-        std::cout << "Extracting cells in range: " << minValue << " -> " << maxValue << std::endl;
-        vtkSmartPointer<vtkPolyData> currentPolyData = this->extractRegionInRange(minValue, maxValue);
-        
-        dividedPolyData.push_back(currentPolyData);
+    // しきい値が変わっていないバンドはキャッシュを再利用し、変わったバンドのみ再計算する
+    std::vector<int> bandsToCompute;
+    for (int i = 0; i < bandCount; ++i) {
+        auto it = bandCache.find({stressValues[i], stressValues[i + 1]});
+        if (it != bandCache.end()) {
+            std::cout << "Reusing cached cells in range: " << stressValues[i] << " -> " << stressValues[i + 1] << std::endl;
+            dividedPolyData[i] = it->second;
+        } else {
+            bandsToCompute.push_back(i);
+        }
+    }
+
+    if (!bandsToCompute.empty()) {
+        auto computed = divideBands(bandsToCompute);
+        profile.addCount("bands computed", static_cast<std::int64_t>(bandsToCompute.size()));
+        for (size_t k = 0; k < bandsToCompute.size(); ++k) {
+            dividedPolyData[bandsToCompute[k]] = computed[k];
+        }
+    }
+
+    // キャッシュは直近の分割結果のみ保持する（ハンドルを1つ動かすと隣接2バンドのみ再計算になる）
+    bandCache.clear();
+    for (int i = 0; i < bandCount; ++i) {
+        bandCache[{stressValues[i], stressValues[i + 1]}] = dividedPolyData[i];
+        if (dividedPolyData[i]) {
+            profile.addCount("triangles", dividedPolyData[i]->GetNumberOfPolys());
+        }
     }
+    profile.addCount("bands reused", bandCount - static_cast<std::int64_t>(bandsToCompute.size()));
 
     return dividedPolyData;
 }
 
+std::vector<vtkSmartPointer<vtkPolyData>> VtkProcessor::divideBands(const std::vector<int>& bandIndices) {
+    if (pieces.size() == 1) {
+        // 応力区間インデックスで各バンドに振り分け、しきい値をまたぐセルのみクリップする
+        const DataPiece& piece = pieces.front();
+        StressBandDivider divider(piece.grid, detectedStressLabel, &piece.stressIndex);
+        divider.setProcessControl(processControl);
+        divider.classifyCells(stressValues, bandIndices);
+
+        for (int i : bandIndices) {
+            double minValue = stressValues[i];
+            double maxValue = stressValues[i + 1];
+            std::cout << "Extracting cells in range: " << minValue << " -> " << maxValue
+                      << " (" << divider.getBandCellCount(i) << " cells, "
+                      << divider.getBandStraddlingCellCount(i) << " clipped)" << std::endl;
+        }
+
+        // 各バンドは独立しているため並列に切り出す
+        return divider.extractBands(bandIndices);
+    }
+
+    // 分割されたデータセットは、ピースごとに各バンドの体積メッシュを並列に切り出し、
+    // バンドごとに全ピースの結果を結合してから表面を抽出する
+    // （結合時に重複点を統合するため、ピースの境界面はバンドの表面に残らない）
+    const size_t bandCount = bandIndices.size();
+    const double totalSteps = static_cast<double>(pieces.size() + bandCount);
+    std::atomic<size_t> completed{0};
+    std::vector<std::vector<vtkSmartPointer<vtkUnstructuredGrid>>> pieceBands(pieces.size());
+    ParallelUtility::parallelFor(pieces.size(), [&](size_t p) {
+        Profiler::Scope pieceProfile("Divide piece");
+        StressBandDivider divider(pieces[p].grid, detectedStressLabel, &pieces[p].stressIndex);
+        divider.setProcessControl(processControl);
+        divider.classifyCells(stressValues, bandIndices);
+        pieceBands[p] = divider.extractBandGrids(bandIndices);
+        pieceProfile.addCount("cells", pieces[p].grid->GetNumberOfCells());
+        if (processControl) {
+            processControl->reportProgress(static_cast<double>(++completed) / totalSteps);
+        }
+    });
+
+    std::vector<vtkSmartPointer<vtkPolyData>> bands(bandCount);
+    std::vector<vtkIdType> bandCellCounts(bandCount, 0);
+    ParallelUtility::parallelFor(bandCount, [&](size_t k) {
+        Profiler::Scope mergeProfile("Merge band pieces");
+        std::vector<vtkSmartPointer<vtkUnstructuredGrid>> bandGrids;
+        for (const auto& grids : pieceBands) {
+            bandGrids.push_back(grids[k]);
+        }
+        vtkSmartPointer<vtkUnstructuredGrid> merged = StressBandDivider::mergeGrids(bandGrids, processControl);
+        bandCellCounts[k] = merged->GetNumberOfCells();
+        bands[k] = bandCellCounts[k] == 0 ? vtkSmartPointer<vtkPolyData>::New()
+                                          : StressBandDivider::extractSurface(merged, processControl);
+        mergeProfile.addCount("triangles", bands[k]->GetNumberOfPolys());
+        if (processControl) {
+            processControl->reportProgress(static_cast<double>(++completed) / totalSteps);
+        }
+    });
+
+    for (size_t k = 0; k < bandCount; ++k) {
+        const int i = bandIndices[k];
+        std::cout << "Extracted cells in range: " << stressValues[i] << " -> " << stressValues[i + 1]
+                  << " (" << bandCellCounts[k] << " cells from " << pieces.size() << " pieces)" << std::endl;
+    }
+    return bands;
+}
+
+vtkSmartPointer<vtkPolyData> VtkProcessor::getOuterSurface() {
+    if (!outerSurface && !pieces.empty()) {
+        Profiler::Scope profile("Extract outer surface");
+        // グリッドは表示側とも共有されるため、表面抽出が内部状態を更新しないよう配列を共有したコピーから抽出する
+        auto extractPieceSurface = [this](const DataPiece& piece) {
+            vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+            grid->ShallowCopy(piece.grid);
+            return StressBandDivider::extractSurface(grid, processControl);
+        };
+        if (pieces.size() == 1) {
+            outerSurface = extractPieceSurface(pieces.front());
+        } else {
+            // プレビュー用のため、ピースの表面をそのまま結合する（ピースの境界面は内部に隠れる）
+            std::vector<vtkSmartPointer<vtkPolyData>> surfaces(pieces.size());
+            ParallelUtility::parallelFor(pieces.size(), [&](size_t i) {
+                surfaces[i] = extractPieceSurface(pieces[i]);
+            });
+            vtkSmartPointer<vtkAppendPolyData> appendFilter = vtkSmartPointer<vtkAppendPolyData>::New();
+            for (const auto& surface : surfaces) {
+                appendFilter->AddInputData(surface);
+            }
+            appendFilter->Update();
+            outerSurface = appendFilter->GetOutput();
+        }
+        // バンドごとのコピーがセル情報を共有して構築し直さないよう、先に構築しておく
+        outerSurface->BuildCells();
+        profile.addCount("triangles", outerSurface->GetNumberOfPolys());
+    }
+    return outerSurface;
+}
+
+std::vector<vtkSmartPointer<vtkPolyData>> VtkProcessor::divideMeshPreview() {
+    Profiler::Scope profile("Divide mesh preview");
+    const int bandCount = isoSurfaceNum - 1;
+    std::vector<vtkSmartPointer<vtkPolyData>> preview(std::max(bandCount, 0));
+    vtkSmartPointer<vtkPolyData> surface = getOuterSurface();
+    if (!surface) {
+        return preview;
+    }
+    ParallelUtility::parallelFor(preview.size(), [&](size_t i) {
+        // 入力のデータオブジェクトはパイプラインの更新で情報やタイムスタンプが書き換えられるため、
+        // 同じ表面を複数のフィルタで同時に使わないよう、配列を共有したバンドごとのコピーをクリップする
+        vtkSmartPointer<vtkPolyData> bandSurface = vtkSmartPointer<vtkPolyData>::New();
+        bandSurface->ShallowCopy(surface);
+        preview[i] = StressBandDivider::clipSurfaceRange(bandSurface, detectedStressLabel,
+                                                         stressValues[i], stressValues[i + 1], processControl);
+    });
+    profile.addCount("triangles", surface->GetNumberOfPolys());
+    return preview;
+}
+
 void VtkProcessor::clearPreviousData(){
     stressValues.clear();
     dividedMeshes.clear();
 }
 
+void VtkProcessor::clearBandCache(){
+    bandCache.clear();
+}
+
 void VtkProcessor::prepareStressValues(const std::vector<double>& thresholds) {
     stressValues.clear();
     for (double v : thresholds) {
@@ -157,20 +883,38 @@ void VtkProcessor::prepareStressValues(const std::vector<double>& thresholds) {
     std::cout << "isoSurfaceNum: " << isoSurfaceNum << std::endl;
 }
 
-void VtkProcessor::savePolyDataAsSTL(vtkPolyData* polyData, const std::string& fileName) {
-    std::filesystem::path tempDirPath = TempPathUtility::getTempSubDirPath("div");
+std::filesystem::path VtkProcessor::getDividedMeshDirectory() const {
+    if (workspace) {
+        return workspace->getSubDirPath("div");
+    }
+    return TempPathUtility::getTempSubDirPath("div");
+}
+
+bool VtkProcessor::ensureDividedMeshDirectory() {
+    std::filesystem::path tempDirPath = getDividedMeshDirectory();
     // .tempディレクトリが存在しなければ作成
     if (!std::filesystem::exists(tempDirPath)) {
         try {
             std::filesystem::create_directories(tempDirPath);
         } catch (const std::filesystem::filesystem_error& e) {
             std::cerr << "Failed to create directory: " << e.what() << std::endl;
-            return; // 作成に失敗した場合は処理を中断
+            return false;
         }
     }
-    
+    return true;
+}
+
+void VtkProcessor::savePolyDataAsSTL(vtkPolyData* polyData, const std::string& fileName) {
+    if (!ensureDividedMeshDirectory()) {
+        return; // 作成に失敗した場合は処理を中断
+    }
+    writePolyDataAsSTL(polyData, fileName);
+}
+
+bool VtkProcessor::writePolyDataAsSTL(vtkPolyData* polyData, const std::string& fileName) const {
+    Profiler::Scope profile("Write STL");
     // 出力ファイルのフルパスを組み立てる
-    std::filesystem::path outputFilePath = tempDirPath / fileName;
+    std::filesystem::path outputFilePath = getDividedMeshDirectory() / fileName;
     
     vtkSmartPointer<vtkSTLWriter> writer = vtkSmartPointer<vtkSTLWriter>::New();
 
@@ -181,49 +925,39 @@ void VtkProcessor::savePolyDataAsSTL(vtkPolyData* polyData, const std::string& f
 
     if (!writer->Write()) {
         std::cerr << "Error: Failed to write STL file: " << outputFilePath << std::endl;
+        return false;
     }
+    std::error_code ec;
+    profile.addCount("triangles", polyData->GetNumberOfPolys());
+    profile.addCount("bytes written", static_cast<std::int64_t>(std::filesystem::file_size(outputFilePath, ec)));
+    return true;
 }
 
 vtkSmartPointer<vtkActor> VtkProcessor::getVtuActor(const std::string& fileName){
-    // VTKファイルの読み込み
-    vtkSmartPointer<vtkXMLUnstructuredGridReader> reader =
-    vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    reader->SetFileName(fileName.c_str());
-    reader->Update();
-
-    // 読み込んだデータセットを取得
-    vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid = reader->GetOutput();
-    if (!unstructuredGrid){
-        std::cerr << "Error: Unable to read the VTK file." << std::endl;
+    // VTKファイルの読み込みとストレスラベルの検出
+    std::string stressLabel;
+    std::vector<DataPiece> displayPieces = readStressPieces(fileName, stressLabel);
+    if (displayPieces.empty()){
+        std::cerr << "Error: Could not load VTK file or detect stress label." << std::endl;
         return nullptr;
     }
 
-    // 一時的にvtuDataを設定してラベル検出を行う
-    vtkSmartPointer<vtkUnstructuredGrid> originalVtuData = vtuData;
-    vtuData = unstructuredGrid;
-    
-    // ストレスラベルを検出
-    std::string stressLabel = detectStressLabel();
-    if (stressLabel.empty()) {
-        std::cerr << "Error: Could not detect stress label." << std::endl;
-        vtuData = originalVtuData;
-        return nullptr;
+    // ストレスラベルは読み込み時にアクティブスカラーとして設定済み
+    // ストレスのレンジを取得（分割されたデータセットは全ピースの範囲）
+    // グリッドは処理スレッドと共有されるため、範囲はキャッシュ登録時に求めたものを使う
+    double stressRange[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()};
+    for (const auto& piece : displayPieces) {
+        stressRange[0] = std::min(stressRange[0], piece.scalarRange[0]);
+        stressRange[1] = std::max(stressRange[1], piece.scalarRange[1]);
     }
-    
-    // 元のvtuDataを復元
-    vtuData = originalVtuData;
 
-    // ストレスラベルをアクティブスカラーとして設定
-    vtkPointData* pointData = unstructuredGrid->GetPointData();
-    if (!pointData){
-        std::cerr << "Error: No point data found in the file." << std::endl;
-        return nullptr;
+    // 描画パイプラインはグリッドの内部状態を更新するため、配列を共有した表示専用のコピーを渡す
+    std::vector<vtkSmartPointer<vtkUnstructuredGrid>> displayGrids;
+    for (const auto& piece : displayPieces) {
+        vtkSmartPointer<vtkUnstructuredGrid> displayGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+        displayGrid->ShallowCopy(piece.grid);
+        displayGrids.push_back(displayGrid);
     }
-    pointData->SetActiveScalars(stressLabel.c_str());
-
-    // ストレスのレンジを取得
-    double stressRange[2];
-    unstructuredGrid->GetScalarRange(stressRange);
     minStress = stressRange[0];
     maxStress = stressRange[1];
 
@@ -239,13 +973,60 @@ vtkSmartPointer<vtkActor> VtkProcessor::getVtuActor(const std::string& fileName)
     lookupTable->SetSaturationRange(0.0, 0.0); // Saturationは使用しない
     lookupTable->SetValueRange(1.0, 1.0); // 明度を1に固定
     lookupTable->SetAlphaRange(1.0, 1.0); // 透明度を1に固定
+    fillGradientLookupTable(lookupTable);
     
+    lookupTable->Build();
+
+    // メンバー変数に保存
+    currentLookupTable = lookupTable;
+    bandPreviewEnabled = false;
+
+    // Mapperの作成
+    vtkSmartPointer<vtkMapper> mapper;
+    if (displayPieces.size() == 1) {
+        vtkSmartPointer<vtkDataSetMapper> dataSetMapper = vtkSmartPointer<vtkDataSetMapper>::New();
+        dataSetMapper->SetInputData(displayGrids.front());
+        mapper = dataSetMapper;
+    } else {
+        // 分割されたデータセットはピースを結合せず、ピースごとの表面をまとめて表示する
+        vtkSmartPointer<vtkMultiBlockDataSet> blocks = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+        blocks->SetNumberOfBlocks(static_cast<unsigned int>(displayPieces.size()));
+        for (size_t i = 0; i < displayPieces.size(); ++i) {
+            blocks->SetBlock(static_cast<unsigned int>(i), displayGrids[i]);
+        }
+        vtkSmartPointer<vtkCompositeDataGeometryFilter> geometryFilter =
+            vtkSmartPointer<vtkCompositeDataGeometryFilter>::New();
+        geometryFilter->SetInputData(blocks);
+        vtkSmartPointer<vtkPolyDataMapper> polyDataMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        polyDataMapper->SetInputConnection(geometryFilter->GetOutputPort());
+        mapper = polyDataMapper;
+    }
+    mapper->SetLookupTable(lookupTable);
+    mapper->SetScalarRange(stressRange);
+    mapper->ScalarVisibilityOn();
+    // テクスチャで色を補間し、バンドプレビューの境界をセル内でもはっきり表示する
+    mapper->InterpolateScalarsBeforeMappingOn();
+
+    // Actorの作成
+    vtkSmartPointer<vtkActor> actor =
+    vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+    actor->GetProperty()->SetOpacity(1.0); // 不透明に設定
+    actor->GetProperty()->SetEdgeVisibility(1); // エッジを表示
+    actor->GetProperty()->SetEdgeColor(0.1, 0.1, 0.1); // エッジの色を黒に設定
+    actor->GetProperty()->SetLineWidth(1.0); // エッジの線の太さを設定
+
+    return actor;
+}
+
+void VtkProcessor::fillGradientLookupTable(vtkLookupTable* lookupTable) {
     // ColorManagerの色を取得
     QColor lowColor = ColorManager::LOW_COLOR;
     QColor middleColor = ColorManager::MIDDLE_COLOR;
     QColor highColor = ColorManager::HIGH_COLOR;
     
     // カラーテーブルを手動で設定
+    lookupTable->SetNumberOfTableValues(256);
     for (int i = 0; i < 256; i++) {
         double t = static_cast<double>(i) / 255.0;
         double r, g, b;
@@ -266,43 +1047,13 @@ vtkSmartPointer<vtkActor> VtkProcessor::getVtuActor(const std::string& fileName)
         
         lookupTable->SetTableValue(i, r, g, b, 1.0);
     }
-    
-    lookupTable->Build();
-
-    // メンバー変数に保存
-    currentLookupTable = lookupTable;
-
-    // Mapperの作成
-    vtkSmartPointer<vtkDataSetMapper> mapper =
-    vtkSmartPointer<vtkDataSetMapper>::New();
-    mapper->SetInputData(unstructuredGrid);
-    mapper->SetLookupTable(lookupTable);
-    mapper->SetScalarRange(stressRange);
-    mapper->ScalarVisibilityOn();
-
-    // Actorの作成
-    vtkSmartPointer<vtkActor> actor =
-    vtkSmartPointer<vtkActor>::New();
-    actor->SetMapper(mapper);
-    actor->GetProperty()->SetOpacity(1.0); // 不透明に設定
-    actor->GetProperty()->SetEdgeVisibility(1); // エッジを表示
-    actor->GetProperty()->SetEdgeColor(0.1, 0.1, 0.1); // エッジの色を黒に設定
-    actor->GetProperty()->SetLineWidth(1.0); // エッジの線の太さを設定
-
-    return actor;
 }
 
 
 vtkSmartPointer<vtkActor> VtkProcessor::getStlActor(const std::string& fileName){
 
-    // STLファイルの読み込み
-    vtkSmartPointer<vtkSTLReader> reader =
-        vtkSmartPointer<vtkSTLReader>::New();
-    reader->SetFileName(fileName.c_str());
-    reader->Update();
-
-    // 読み込んだデータセットを取得
-    vtkSmartPointer<vtkPolyData> polyData = reader->GetOutput();
+    // STLファイルの読み込み（3MF作成時と同じインスタンスを共有する）
+    vtkSmartPointer<vtkPolyData> polyData = DatasetCache::instance().getPolyData(fileName);
     if (!polyData)
     {
         std::cerr << "Error: Unable to read the STL file." << std::endl;
@@ -337,6 +1088,14 @@ vtkSmartPointer<vtkActor> VtkProcessor::getColoredStlActor(const std::string& fi
         std::cerr << "Error: Unable to read the STL file." << std::endl;
         return nullptr;
     }
+    return getColoredStlActor(polyData, r, g, b);
+}
+
+vtkSmartPointer<vtkActor> VtkProcessor::getColoredStlActor(vtkPolyData* polyData, double r, double g, double b) {
+    if (!polyData) {
+        std::cerr << "Error: No mesh data to display." << std::endl;
+        return nullptr;
+    }
 
     // Mapperの作成
     vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
@@ -391,6 +1150,42 @@ vtkSmartPointer<vtkActor> VtkProcessor::getColoredStlActorByStress(const std::st
         std::cerr << "Error: Unable to read the STL file." << std::endl;
         return nullptr;
     }
+    return getColoredStlActorByStress(polyData, stressValue, minStress, maxStress);
+}
+
+void VtkProcessor::setBandPreview(const std::vector<double>& thresholds) {
+    if (!currentLookupTable || thresholds.size() < 2) return;
+
+    // テーブルの各要素が表す応力がどのバンドに属するかを求め、バンドごとに一色で塗る
+    // 分割結果の表示と同じく、バンド中央の応力に対応する色を使う
+    // 処理量はテーブルの大きさのみに比例し、メッシュの大きさには依存しない
+    const double range = static_cast<double>(maxStress) - minStress;
+    currentLookupTable->SetNumberOfTableValues(BAND_PREVIEW_TABLE_SIZE);
+    for (int i = 0; i < BAND_PREVIEW_TABLE_SIZE; ++i) {
+        const double stress = minStress + range * (i + 0.5) / BAND_PREVIEW_TABLE_SIZE;
+        const size_t band = static_cast<size_t>(
+            std::upper_bound(thresholds.begin() + 1, thresholds.end() - 1, stress) - (thresholds.begin() + 1));
+        const double bandStress = (thresholds[band] + thresholds[band + 1]) / 2.0;
+        const double t = range > 0.0 ? std::clamp((maxStress - bandStress) / range, 0.0, 1.0) : 0.0;
+        const QColor color = getGradientColorByStress(t);
+        currentLookupTable->SetTableValue(i, color.redF(), color.greenF(), color.blueF(), 1.0);
+    }
+    currentLookupTable->Modified();
+    bandPreviewEnabled = true;
+}
+
+void VtkProcessor::clearBandPreview() {
+    if (!currentLookupTable || !bandPreviewEnabled) return;
+    fillGradientLookupTable(currentLookupTable);
+    currentLookupTable->Modified();
+    bandPreviewEnabled = false;
+}
+
+vtkSmartPointer<vtkActor> VtkProcessor::getColoredStlActorByStress(vtkPolyData* polyData, double stressValue, double minStress, double maxStress) {
+    if (!polyData) {
+        std::cerr << "Error: No mesh data to display." << std::endl;
+        return nullptr;
+    }
 
     // ストレス値を0.0〜1.0に正規化（DensitySliderと同じ計算）
     // 高いストレス値をt=0.0（赤）、低いストレス値をt=1.0（青）にする
@@ -418,13 +1213,36 @@ vtkSmartPointer<vtkActor> VtkProcessor::getColoredStlActorByStress(const std::st
 void VtkProcessor::saveDividedMeshes(const std::vector<vtkSmartPointer<vtkPolyData>>& dividedMeshes)
 {
     const auto& stressValues = this->getStressValues();
-    
+    if (!ensureDividedMeshDirectory()) {
+        return;
+    }
+
+    // ファイル名は事前に決めておき、書き出しのみを並列に行う
+    std::vector<std::string> fileNames;
     for (size_t i = 0; i < dividedMeshes.size(); ++i) {
         float minValue = stressValues[i];
         float maxValue = stressValues[i + 1];
-        std::string fileName = generateMeshFileName(i + 1, minValue, maxValue);
-        this->savePolyDataAsSTL(dividedMeshes[i], fileName);
+        fileNames.push_back(generateMeshFileName(i + 1, minValue, maxValue));
+    }
+
+    ParallelUtility::parallelFor(dividedMeshes.size(), [&](size_t i) {
+        writePolyDataAsSTL(dividedMeshes[i], fileNames[i]);
+    });
+}
+
+std::vector<DividedMesh> VtkProcessor::createDividedMeshList(const std::vector<vtkSmartPointer<vtkPolyData>>& dividedMeshes) const
+{
+    std::vector<DividedMesh> meshes;
+    for (size_t i = 0; i < dividedMeshes.size() && i + 1 < stressValues.size(); ++i) {
+        DividedMesh mesh;
+        mesh.polyData = dividedMeshes[i];
+        mesh.number = static_cast<int>(i) + 1;
+        mesh.minStress = stressValues[i];
+        mesh.maxStress = stressValues[i + 1];
+        mesh.name = generateMeshFileName(mesh.number, mesh.minStress, mesh.maxStress);
+        meshes.push_back(mesh);
     }
+    return meshes;
 }
 
 std::string VtkProcessor::generateMeshFileName(int index,
@@ -44,17 +44,45 @@
 #include <vtkThreshold.h>
 #include <vtkDataSetSurfaceFilter.h>
 #include <vtkDataObject.h>
+#include <vtkMultiBlockDataSet.h>
 
 #include "../../UI/ColorManager.h"
+#include "StressIntervalIndex.h"
+#include "StressEnvelope.h"
+#include "DerivedStress.h"
+#include "DividedMesh.h"
+#include "ProcessControl.h"
+
+class Workspace;
 
 #include <string>
+#include <map>
+#include <utility>
+#include <filesystem>
 
 class VtkProcessor{
 
 
 private:
     std::string vtuFileName;
-    vtkSmartPointer<vtkUnstructuredGrid> vtuData;
+
+    // データセットを作成した読み込み方法（応力区間インデックスのキャッシュの書き出し方を決める）
+    enum class LoadSource {
+        Parsed,       // XMLを解析、または圧縮されたブロックを展開して読み込んだ（バイナリキャッシュを書き出す）
+        RawAppended,  // 圧縮なしの appended 形式から配列をそのまま読み込んだ（インデックスのみを書き出す）
+        BinaryCache   // バイナリキャッシュから読み込んだ（書き出さない）
+    };
+
+    // 読み込んだデータセットの1ピース（.vtu は1ピース、.pvtu はピースファイルごと）
+    struct DataPiece {
+        std::string fileName;
+        vtkSmartPointer<vtkUnstructuredGrid> grid;
+        StressIntervalIndex stressIndex; // セルごとの応力区間（読み込み時に構築）
+        bool cacheable = true; // ファイルの内容そのものか（包絡値はバイナリキャッシュの対象外）
+        LoadSource loadSource = LoadSource::Parsed;
+        double scalarRange[2] = {0.0, 0.0}; // 応力の範囲（共有グリッドの GetScalarRange は使わない）
+    };
+    std::vector<DataPiece> pieces;
     double stressRange[2];
     float minStress;
     float maxStress;
@@ -64,14 +92,83 @@ private:
     vtkSmartPointer<vtkLookupTable> currentLookupTable;
     std::string detectedStressLabel; // 検出されたストレスラベルを保存
 
+    // 読み込み済みファイルの識別情報（同じファイルの再読み込みを省略するため）
+    std::string loadedFileName;
+    std::string loadedFileStamp;
+
+    // 体積メッシュの外表面（粗いプレビュー分割に使用、しきい値に依存しないため読み込みごとに一度だけ構築）
+    vtkSmartPointer<vtkPolyData> outerSurface;
+
+    // バンドごとの分割結果キャッシュ（キー: 下限・上限しきい値）
+    std::map<std::pair<float, float>, vtkSmartPointer<vtkPolyData>> bandCache;
+
+    // 同じメッシュの別の荷重ケース（設定されている場合は vtuFileName と合わせた包絡値を使う）
+    std::vector<std::string> loadCaseFiles;
+    StressEnvelope::Reduction envelopeReduction = StressEnvelope::Reduction::Maximum;
+
+    // テンソルからスカラーの応力を求める方法（既定ではスカラーの応力配列がない場合のみミーゼス応力を求める）
+    DerivedStress::Settings derivedStress;
+
+    // ストレス配列のみを読み込むモード（既定で有効）
+    bool selectiveArrayLoading = true;
+
+    bool isLoadedFileCurrent() const;
+    // 進捗通知とキャンセルの制御（処理パイプラインから設定される）
+    ProcessControl* processControl = nullptr;
+    // 分割STLなどの中間ファイルを書き出す作業領域（未設定の場合は共有の一時ディレクトリ）
+    Workspace* workspace = nullptr;
+
+    std::filesystem::path getDividedMeshDirectory() const;
+    // 読み込み方法をデータセットの情報に記録する（記録がなければ Parsed とみなす）
+    static void setLoadSource(vtkDataObject* data, LoadSource source);
+    static LoadSource getLoadSource(vtkDataObject* data);
+    static vtkSmartPointer<vtkUnstructuredGrid> loadVtuFile(const std::string& fileName, bool selective,
+                                                            const DerivedStress::Settings& stressSettings,
+                                                            ProcessControl* control);
+    // .pvtu の各ピースを並列に読み込み、ピースをブロックとするデータセットを返す
+    static vtkSmartPointer<vtkMultiBlockDataSet> loadPvtuFile(const std::string& fileName, bool selective,
+                                                              const DerivedStress::Settings& stressSettings,
+                                                              ProcessControl* control);
+    // スカラーの応力配列の名前を検出する（見つからなければ空）
+    static std::string findStressLabel(const std::vector<std::string>& arrayNames);
+    // 読み込みに使う配列の区別（DatasetCache の variant）
+    std::string getLoadVariant() const;
+    std::vector<DataPiece> readVtuPieces(const std::string& fileName, std::string& stressLabel);
+    // 荷重ケースが設定されていれば包絡値のピースを、なければ readVtuPieces と同じピースを返す
+    std::vector<DataPiece> readStressPieces(const std::string& fileName, std::string& stressLabel);
+    // fileName と各荷重ケースを読み込み、ピースごとの包絡値をブロックとするデータセットを返す
+    vtkSmartPointer<vtkMultiBlockDataSet> loadEnvelope(const std::string& fileName);
+    // 読み込み済みデータの識別情報（荷重ケースを含む全ファイルのサイズと更新日時、集約方法）
+    std::string getLoadStamp() const;
+    // ピースの応力区間インデックスを読み込むか構築する
+    bool preparePieceIndex(DataPiece& piece);
+    std::vector<vtkSmartPointer<vtkPolyData>> divideBands(const std::vector<int>& bandIndices);
+    // データセットを構成する全ファイルのサイズと更新日時（取得できない場合は空）
+    static std::string getDatasetStamp(const std::string& fileName);
+
+    // バンドプレビューのカラーテーブルの大きさ（境界の解像度は応力範囲の 1/1024）
+    static constexpr int BAND_PREVIEW_TABLE_SIZE = 1024;
+    bool bandPreviewEnabled = false;
+    static void fillGradientLookupTable(vtkLookupTable* lookupTable);
+
+    bool ensureDividedMeshDirectory();
+    bool writePolyDataAsSTL(vtkPolyData* polyData, const std::string& fileName) const;
+
 public:
     VtkProcessor(const std::string& vtuFileName);
     void showInfo();
     bool LoadAndPrepareData();
     void prepareStressValues(const std::vector<double>& thresholds);
     void clearPreviousData();
+    void clearBandCache();
     vtkSmartPointer<vtkPolyData> extractRegionInRange(double lowerBound, double upperBound);
     std::vector<vtkSmartPointer<vtkPolyData>> divideMesh();
+    // 外表面のみをバンドごとに切り出した粗い分割結果（表示用のプレビュー、3MFには使わない）
+    // 処理量は表面の大きさに比例するため、大きな体積メッシュでも divideMesh よりはるかに速い
+    std::vector<vtkSmartPointer<vtkPolyData>> divideMeshPreview();
+    // 外表面を構築する（未構築の場合のみ）
+    vtkSmartPointer<vtkPolyData> getOuterSurface();
+    vtkIdType getCellCount() const;
     void savePolyDataAsSTL(vtkPolyData* polyData, const std::string& fileName);
 
     std::vector<float> getStressValues()                                   const { return stressValues; }
@@ -83,17 +180,56 @@ public:
     vtkSmartPointer<vtkActor> getStlActor(const std::string& fileName);
     vtkSmartPointer<vtkActor> getColoredStlActor(const std::string& fileName, double r, double g, double b);
     vtkSmartPointer<vtkActor> getColoredStlActorByStress(const std::string& fileName, double stressValue, double minStress, double maxStress);
+    vtkSmartPointer<vtkActor> getColoredStlActor(vtkPolyData* polyData, double r, double g, double b);
+    vtkSmartPointer<vtkActor> getColoredStlActorByStress(vtkPolyData* polyData, double stressValue, double minStress, double maxStress);
 
     void saveDividedMeshes(const std::vector<vtkSmartPointer<vtkPolyData>>& dividedMeshes);
+    // 分割結果にバンド番号・応力範囲・メッシュ名を付与する
+    std::vector<DividedMesh> createDividedMeshList(const std::vector<vtkSmartPointer<vtkPolyData>>& dividedMeshes) const;
     std::string generateMeshFileName(int index,
         float minValue,
         float maxValue) const;
     vtkSmartPointer<vtkLookupTable> getCurrentLookupTable() const { return currentLookupTable; }
+
+    // VTUの配色を、しきい値 [最小値, しきい値..., 最大値] で区切ったバンドごとの段階色に切り替える
+    // カラーテーブルのみを書き換えるため、メッシュを分割せずに境界を確認できる
+    void setBandPreview(const std::vector<double>& thresholds);
+    // 連続的なグラデーションの配色に戻す
+    void clearBandPreview();
+    bool isBandPreviewEnabled() const { return bandPreviewEnabled; }
     
     // 新しいメソッド: ストレスラベルを検出
     std::string detectStressLabel();
+    static std::string detectStressLabel(const std::vector<std::string>& arrayNames);
+    // 点配列名から読み込む応力の配列を選ぶ
+    // スカラーの応力配列がなければ（または Auto 以外を指定した場合は）テンソルか成分配列を選ぶ
+    static DerivedStress::Selection selectStressArrays(const std::vector<std::string>& arrayNames,
+                                                       const DerivedStress::Settings& settings);
     std::string getDetectedStressLabel() const { return detectedStressLabel; }
+
+    // .pvtu（ピースごとの .vtu に分割されたデータセット）かどうか
+    static bool isPartitionedFile(const std::string& fileName);
+    // データセットを構成する .vtu ファイル（.vtu はそのファイルのみ、.pvtu は各ピース、読み込めない場合は空）
+    static std::vector<std::string> getPieceFileNames(const std::string& fileName);
     
+    // 同じメッシュに対する別の荷重ケースの結果ファイルを設定する
+    // 設定すると、応力範囲・区間インデックス・分割・表示はすべて vtuFileName と各ケースの包絡値で行う
+    void setLoadCaseFiles(const std::vector<std::string>& files,
+                          StressEnvelope::Reduction reduction = StressEnvelope::Reduction::Maximum);
+    const std::vector<std::string>& getLoadCaseFiles() const { return loadCaseFiles; }
+    StressEnvelope::Reduction getEnvelopeReduction() const { return envelopeReduction; }
+
+    // テンソルから求める応力（ミーゼス・最大主応力・トレスカ・安全率）を設定する
+    void setDerivedStress(const DerivedStress::Settings& settings);
+    const DerivedStress::Settings& getDerivedStress() const { return derivedStress; }
+
+    // ストレス配列のみを読み込むかどうか（無効にすると全配列を読み込む）
+    void setSelectiveArrayLoading(bool enabled);
+    bool isSelectiveArrayLoading() const { return selectiveArrayLoading; }
+
+    void setProcessControl(ProcessControl* control) { processControl = control; }
+    void setWorkspace(Workspace* workspace) { this->workspace = workspace; }
+
     // ファイル名を設定するメソッド
     void setVtuFileName(const std::string& fileName) { vtuFileName = fileName; }
 
@@ -0,0 +1,509 @@
+#include "VtuBinaryCache.h"
+#include "ResultCache.h"
+#include "MappedDataArray.h"
+#include "../../utils/tempPathUtility.h"
+#include "../../utils/profiler.h"
+#include <QCoreApplication>
+#include <vtkCellArray.h>
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkUnsignedCharArray.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace {
+constexpr char CACHE_MAGIC[8] = {'S', '3', 'D', 'V', 'T', 'U', '\0', '\0'};
+// 形式を変更した場合は番号を上げ、以前のキャッシュを使わないようにする
+// 2: テンソルのみを持つVTUは、先頭の配列ではなく求めた相当応力を保存する
+// 3: 応力区間インデックスのみのキャッシュ（flags）に対応する
+constexpr std::uint32_t CACHE_FORMAT_VERSION = 3;
+// 点・セル・ストレス配列のセクションを持たず、応力区間インデックスのみを保存したキャッシュ
+constexpr std::uint32_t INDEX_ONLY_FLAG = 1;
+// 書き出したマシンとバイト順が異なるキャッシュは使わない
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+// 各セクションの先頭はキャッシュラインに揃える
+constexpr std::uint64_t SECTION_ALIGNMENT = 64;
+constexpr const char* CACHE_EXTENSION = ".s3dvtu";
+// キャッシュ全体の既定の上限サイズ（MiB）
+constexpr std::uintmax_t DEFAULT_MAX_MB = 4096;
+// これより古い一時ファイルは書き込み途中で終了したプロセスのものとみなして削除する
+constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+enum Section {
+    PointSection,         // 点座標（float または double、3成分）
+    OffsetSection,        // セルのオフセット（int64、セル数+1）
+    ConnectivitySection,  // セルの接続（int64）
+    TypeSection,          // セルタイプ（uint8）
+    StressSection,        // ストレス配列（float または double）
+    CellMinSection,       // 応力区間インデックスの最小値（float）
+    CellMaxSection,       // 応力区間インデックスの最大値（float）
+    LabelSection,         // ストレス配列の名前
+    SectionCount
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    std::uint64_t pointCount;
+    std::uint64_t cellCount;
+    std::uint64_t connectivitySize;
+    std::int32_t pointType;
+    std::int32_t stressType;
+    std::int32_t stressComponents;
+    std::uint32_t labelLength;
+    std::uint64_t sectionOffsets[SectionCount];
+    std::uint64_t sectionSizes[SectionCount];
+};
+static_assert(std::is_trivially_copyable<Header>::value, "Header must be trivially copyable");
+
+std::atomic<std::uint64_t> tempCounter{0};
+std::mutex evictMutex;
+
+std::uint64_t alignOffset(std::uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+bool isSupportedValueType(int type)
+{
+    return type == VTK_FLOAT || type == VTK_DOUBLE;
+}
+
+std::filesystem::path getCacheDir()
+{
+    const char* value = std::getenv("STRECS3D_VTU_CACHE_DIR");
+    if (value && *value) {
+        return std::filesystem::path(value);
+    }
+    return TempPathUtility::getTempDirPath() / "vtu-cache";
+}
+
+std::uintmax_t getMaxBytes()
+{
+    std::uintmax_t maxMb = DEFAULT_MAX_MB;
+    const char* value = std::getenv("STRECS3D_VTU_CACHE_MAX_MB");
+    if (value && *value) {
+        maxMb = static_cast<std::uintmax_t>(std::strtoull(value, nullptr, 10));
+    }
+    return maxMb * 1024 * 1024;
+}
+
+// 上限サイズを超えた分を、最終使用時刻（読み込み時に更新する更新日時）の古いキャッシュから削除する
+// keep は書き出した直後のキャッシュで、削除の対象にしない
+// マップ中のキャッシュを削除しても、POSIX ではマップは有効なまま（Windows では削除に失敗して残る）
+void evict(const std::filesystem::path& keep)
+{
+    std::lock_guard<std::mutex> lock(evictMutex);
+    const std::uintmax_t maxBytes = getMaxBytes();
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    struct EntryInfo {
+        std::filesystem::file_time_type lastUsed;
+        std::filesystem::path path;
+        std::uintmax_t size;
+    };
+    std::vector<EntryInfo> entries;
+    std::uintmax_t totalSize = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(keep.parent_path(), ec)) {
+        std::error_code entryError;
+        if (!entry.is_regular_file(entryError)) continue;
+        const std::filesystem::path& path = entry.path();
+        const auto lastUsed = entry.last_write_time(entryError);
+        if (entryError) continue;
+        if (path.filename().string().find(std::string(CACHE_EXTENSION) + ".tmp-") != std::string::npos) {
+            if (now - lastUsed > STALE_TEMP_AGE) {
+                std::filesystem::remove(path, entryError);
+            }
+            continue;
+        }
+        if (path.extension() != CACHE_EXTENSION) continue;
+        const std::uintmax_t size = entry.file_size(entryError);
+        if (entryError) continue;
+        totalSize += size;
+        if (path != keep) {
+            entries.push_back({lastUsed, path, size});
+        }
+    }
+    if (totalSize <= maxBytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const EntryInfo& a, const EntryInfo& b) { return a.lastUsed < b.lastUsed; });
+    for (const auto& entry : entries) {
+        if (totalSize <= maxBytes) break;
+        std::error_code removeError;
+        if (!std::filesystem::remove(entry.path, removeError)) continue;
+        totalSize -= entry.size;
+        std::cout << "Evicted VTU binary cache: " << entry.path.filename().string() << std::endl;
+    }
+}
+
+bool getSourceStamp(const std::string& sourcePath, std::uint64_t& size, std::int64_t& time)
+{
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(sourcePath, ec);
+    if (ec) return false;
+    const auto fileTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) return false;
+    size = static_cast<std::uint64_t>(fileSize);
+    time = static_cast<std::int64_t>(fileTime.time_since_epoch().count());
+    return true;
+}
+
+// マップしたキャッシュのヘッダーを検証する（元ファイルの更新やセクションの不整合があれば false）
+bool readHeader(const MappedFile& file, const std::string& sourcePath, Header& header)
+{
+    if (file.size() < sizeof(Header)) {
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(Header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+        || header.version != CACHE_FORMAT_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceTime = 0;
+    if (!getSourceStamp(sourcePath, sourceSize, sourceTime)
+        || header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+        return false;
+    }
+
+    if ((header.flags & ~INDEX_ONLY_FLAG) != 0) {
+        return false;
+    }
+    const bool indexOnly = (header.flags & INDEX_ONLY_FLAG) != 0;
+    if (!indexOnly && (!isSupportedValueType(header.pointType) || !isSupportedValueType(header.stressType)
+                       || header.stressComponents < 1)) {
+        return false;
+    }
+    const std::array<std::uint64_t, SectionCount> expectedSizes = indexOnly ? std::array<std::uint64_t, SectionCount>{
+        0, 0, 0, 0, 0,
+        header.cellCount * sizeof(float),
+        header.cellCount * sizeof(float),
+        header.labelLength} : std::array<std::uint64_t, SectionCount>{
+        header.pointCount * 3 * static_cast<std::uint64_t>(vtkDataArray::GetDataTypeSize(header.pointType)),
+        (header.cellCount + 1) * sizeof(std::int64_t),
+        header.connectivitySize * sizeof(std::int64_t),
+        header.cellCount,
+        header.pointCount * static_cast<std::uint64_t>(header.stressComponents)
+            * static_cast<std::uint64_t>(vtkDataArray::GetDataTypeSize(header.stressType)),
+        header.cellCount * sizeof(float),
+        header.cellCount * sizeof(float),
+        header.labelLength};
+    for (int section = 0; section < SectionCount; ++section) {
+        const std::uint64_t offset = header.sectionOffsets[section];
+        const std::uint64_t size = header.sectionSizes[section];
+        if (size != expectedSizes[section] || offset % SECTION_ALIGNMENT != 0
+            || offset > file.size() || size > file.size() - offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Header makeHeader(std::uint32_t flags)
+{
+    Header header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.flags = flags;
+    return header;
+}
+
+// セクションを揃えて一時ファイルに書き出し、rename で置き換える（bytes に書き出したバイト数を返す）
+bool writeCacheFile(const std::filesystem::path& cachePath, Header& header, const void* const* sectionData,
+                    const std::uint64_t* sectionSizes, std::uint64_t& bytes)
+{
+    std::uint64_t offset = alignOffset(sizeof(Header));
+    for (int section = 0; section < SectionCount; ++section) {
+        header.sectionOffsets[section] = offset;
+        header.sectionSizes[section] = sectionSizes[section];
+        offset = alignOffset(offset + sectionSizes[section]);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cachePath.parent_path(), ec);
+    const std::filesystem::path tempPath = cachePath.string() + ".tmp-"
+        + std::to_string(QCoreApplication::applicationPid()) + "-" + std::to_string(++tempCounter);
+
+    bool written = false;
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (stream) {
+            const char padding[SECTION_ALIGNMENT] = {};
+            std::uint64_t position = sizeof(Header);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            for (int section = 0; section < SectionCount && stream; ++section) {
+                stream.write(padding, static_cast<std::streamsize>(header.sectionOffsets[section] - position));
+                if (sectionSizes[section] > 0) {
+                    stream.write(static_cast<const char*>(sectionData[section]),
+                                 static_cast<std::streamsize>(sectionSizes[section]));
+                }
+                position = header.sectionOffsets[section] + sectionSizes[section];
+            }
+            written = static_cast<bool>(stream.flush());
+        }
+    }
+    if (written) {
+        std::filesystem::rename(tempPath, cachePath, ec);
+        written = !ec;
+    }
+    if (!written) {
+        std::filesystem::remove(tempPath, ec);
+        std::cerr << "Warning: Failed to write VTU binary cache: " << cachePath.string() << std::endl;
+        return false;
+    }
+
+    bytes = offset;
+    std::cout << "Wrote VTU binary cache: " << cachePath.string() << std::endl;
+    evict(cachePath);
+    return true;
+}
+
+// 32bitで保持されているセル配列は64bitに変換して書き出す
+const void* getInt64Data(vtkCellArray* cells, bool offsets, std::vector<std::int64_t>& converted)
+{
+    if (cells->IsStorage64Bit()) {
+        vtkTypeInt64Array* array = offsets ? cells->GetOffsetsArray64() : cells->GetConnectivityArray64();
+        return array->GetPointer(0);
+    }
+    vtkTypeInt32Array* array = offsets ? cells->GetOffsetsArray32() : cells->GetConnectivityArray32();
+    const vtkTypeInt32* values = array->GetPointer(0);
+    converted.assign(values, values + array->GetNumberOfValues());
+    return converted.data();
+}
+} // namespace
+
+bool VtuBinaryCache::isEnabled()
+{
+    const char* value = std::getenv("STRECS3D_VTU_CACHE");
+    if (!value) {
+        return true;
+    }
+    const std::string setting(value);
+    return setting != "0" && setting != "off";
+}
+
+std::filesystem::path VtuBinaryCache::getCachePath(const std::string& sourcePath, const std::string& variant)
+{
+    // 同じ名前の別のファイルと区別するため、絶対パスのハッシュを付ける
+    std::error_code ec;
+    std::filesystem::path absolutePath = std::filesystem::absolute(sourcePath, ec);
+    if (ec) {
+        absolutePath = sourcePath;
+    }
+    ResultCache::KeyBuilder keyBuilder;
+    keyBuilder.addString(absolutePath.lexically_normal().string());
+    if (!variant.empty()) {
+        keyBuilder.addString(variant);
+    }
+    const std::string name = absolutePath.filename().string() + "-" + keyBuilder.build().substr(0, 16) + CACHE_EXTENSION;
+    return getCacheDir() / name;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> VtuBinaryCache::read(const std::string& sourcePath, std::string& stressLabel,
+                                                          const std::string& variant)
+{
+    if (!isEnabled()) {
+        return nullptr;
+    }
+    const std::filesystem::path cachePath = getCachePath(sourcePath, variant);
+    std::shared_ptr<MappedFile> file = MappedFile::open(cachePath.string());
+    if (!file) {
+        return nullptr;
+    }
+    Header header;
+    if (!readHeader(*file, sourcePath, header)) {
+        std::cout << "Ignoring outdated VTU binary cache for " << sourcePath << std::endl;
+        return nullptr;
+    }
+    // インデックスのみのキャッシュは、元ファイルを直接読み込む場合に使う
+    if ((header.flags & INDEX_ONLY_FLAG) != 0) {
+        return nullptr;
+    }
+    // 最終使用時刻を更新し、削除の対象になりにくくする（元ファイルとの照合はヘッダーの値で行う）
+    std::error_code touchError;
+    std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), touchError);
+
+    Profiler::Scope profile("Read VTU binary cache");
+    profile.addCount("bytes", static_cast<std::int64_t>(file->size()));
+
+    std::uint8_t* data = file->data();
+    vtkNew<vtkPoints> points;
+    points->SetData(MappedDataArray::wrap(file, data + header.sectionOffsets[PointSection], header.pointType, 3,
+                                          static_cast<vtkIdType>(header.pointCount)));
+
+    vtkSmartPointer<vtkDataArray> offsets = MappedDataArray::wrap(
+        file, data + header.sectionOffsets[OffsetSection], VTK_TYPE_INT64, 1, static_cast<vtkIdType>(header.cellCount + 1));
+    vtkSmartPointer<vtkDataArray> connectivity = MappedDataArray::wrap(
+        file, data + header.sectionOffsets[ConnectivitySection], VTK_TYPE_INT64, 1,
+        static_cast<vtkIdType>(header.connectivitySize));
+    vtkNew<vtkCellArray> cells;
+    cells->SetData(vtkTypeInt64Array::SafeDownCast(offsets), vtkTypeInt64Array::SafeDownCast(connectivity));
+
+    vtkSmartPointer<vtkDataArray> cellTypes = MappedDataArray::wrap(
+        file, data + header.sectionOffsets[TypeSection], VTK_TYPE_UINT8, 1, static_cast<vtkIdType>(header.cellCount));
+
+    stressLabel.assign(reinterpret_cast<const char*>(data + header.sectionOffsets[LabelSection]), header.labelLength);
+    vtkSmartPointer<vtkDataArray> stress = MappedDataArray::wrap(
+        file, data + header.sectionOffsets[StressSection], header.stressType, header.stressComponents,
+        static_cast<vtkIdType>(header.pointCount));
+    stress->SetName(stressLabel.c_str());
+
+    vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->SetPoints(points);
+    grid->SetCells(vtkUnsignedCharArray::SafeDownCast(cellTypes), cells);
+    grid->GetPointData()->AddArray(stress);
+    grid->GetPointData()->SetActiveScalars(stressLabel.c_str());
+
+    profile.addCount("cells", grid->GetNumberOfCells());
+    profile.addCount("points", grid->GetNumberOfPoints());
+    std::cout << "Mapped VTU binary cache: " << cachePath.string() << std::endl;
+    return grid;
+}
+
+bool VtuBinaryCache::readIndex(const std::string& sourcePath, vtkIdType cellCount, StressIntervalIndex& index,
+                               const std::string& variant)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    const std::filesystem::path cachePath = getCachePath(sourcePath, variant);
+    std::shared_ptr<MappedFile> file = MappedFile::open(cachePath.string());
+    Header header;
+    if (!file || !readHeader(*file, sourcePath, header)
+        || header.cellCount != static_cast<std::uint64_t>(cellCount)) {
+        return false;
+    }
+    std::error_code touchError;
+    std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), touchError);
+    const float* cellMin = reinterpret_cast<const float*>(file->data() + header.sectionOffsets[CellMinSection]);
+    const float* cellMax = reinterpret_cast<const float*>(file->data() + header.sectionOffsets[CellMaxSection]);
+    index.assign(std::vector<float>(cellMin, cellMin + header.cellCount),
+                 std::vector<float>(cellMax, cellMax + header.cellCount));
+    return true;
+}
+
+bool VtuBinaryCache::write(const std::string& sourcePath, vtkUnstructuredGrid* grid, const std::string& stressLabel,
+                           const StressIntervalIndex& index, const std::string& variant)
+{
+    if (!isEnabled() || !grid || !grid->GetPoints() || !grid->GetCells() || !grid->GetCellTypesArray()) {
+        return false;
+    }
+    Profiler::Scope profile("Write VTU binary cache");
+
+    vtkDataArray* points = grid->GetPoints()->GetData();
+    vtkDataArray* stress = grid->GetPointData()->GetArray(stressLabel.c_str());
+    vtkCellArray* cells = grid->GetCells();
+    vtkUnsignedCharArray* cellTypes = grid->GetCellTypesArray();
+    const vtkIdType cellCount = grid->GetNumberOfCells();
+    if (!points || !stress || !isSupportedValueType(points->GetDataType()) || !isSupportedValueType(stress->GetDataType())
+        || !points->HasStandardMemoryLayout() || !stress->HasStandardMemoryLayout()
+        || points->GetNumberOfComponents() != 3 || index.getCellCount() != cellCount) {
+        return false;
+    }
+    // 多面体セルの面情報は保存しない
+    const unsigned char* types = cellTypes->GetPointer(0);
+    if (std::find(types, types + cellCount, static_cast<unsigned char>(VTK_POLYHEDRON)) != types + cellCount) {
+        std::cout << "Skipping VTU binary cache for polyhedral cells" << std::endl;
+        return false;
+    }
+
+    Header header = makeHeader(0);
+    if (!getSourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+    header.pointCount = static_cast<std::uint64_t>(grid->GetNumberOfPoints());
+    header.cellCount = static_cast<std::uint64_t>(cellCount);
+    header.connectivitySize = static_cast<std::uint64_t>(cells->GetNumberOfConnectivityIds());
+    header.pointType = points->GetDataType();
+    header.stressType = stress->GetDataType();
+    header.stressComponents = stress->GetNumberOfComponents();
+    header.labelLength = static_cast<std::uint32_t>(stressLabel.size());
+
+    std::vector<std::int64_t> convertedOffsets;
+    std::vector<std::int64_t> convertedConnectivity;
+    const void* sectionData[SectionCount] = {
+        points->GetVoidPointer(0),
+        getInt64Data(cells, true, convertedOffsets),
+        getInt64Data(cells, false, convertedConnectivity),
+        types,
+        stress->GetVoidPointer(0),
+        index.getCellMinValues().data(),
+        index.getCellMaxValues().data(),
+        stressLabel.data()};
+    const std::uint64_t sectionSizes[SectionCount] = {
+        header.pointCount * 3 * static_cast<std::uint64_t>(points->GetDataTypeSize()),
+        (header.cellCount + 1) * sizeof(std::int64_t),
+        header.connectivitySize * sizeof(std::int64_t),
+        header.cellCount,
+        header.pointCount * static_cast<std::uint64_t>(header.stressComponents)
+            * static_cast<std::uint64_t>(stress->GetDataTypeSize()),
+        header.cellCount * sizeof(float),
+        header.cellCount * sizeof(float),
+        header.labelLength};
+    std::uint64_t bytes = 0;
+    if (!writeCacheFile(getCachePath(sourcePath, variant), header, sectionData, sectionSizes, bytes)) {
+        return false;
+    }
+    profile.addCount("bytes", static_cast<std::int64_t>(bytes));
+    return true;
+}
+
+bool VtuBinaryCache::writeIndex(const std::string& sourcePath, const std::string& stressLabel,
+                                const StressIntervalIndex& index, const std::string& variant)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    Profiler::Scope profile("Write VTU index cache");
+
+    Header header = makeHeader(INDEX_ONLY_FLAG);
+    if (!getSourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+    header.cellCount = static_cast<std::uint64_t>(index.getCellCount());
+    header.labelLength = static_cast<std::uint32_t>(stressLabel.size());
+
+    const void* sectionData[SectionCount] = {
+        nullptr, nullptr, nullptr, nullptr, nullptr,
+        index.getCellMinValues().data(),
+        index.getCellMaxValues().data(),
+        stressLabel.data()};
+    const std::uint64_t sectionSizes[SectionCount] = {
+        0, 0, 0, 0, 0,
+        header.cellCount * sizeof(float),
+        header.cellCount * sizeof(float),
+        header.labelLength};
+    std::uint64_t bytes = 0;
+    if (!writeCacheFile(getCachePath(sourcePath, variant), header, sectionData, sectionSizes, bytes)) {
+        return false;
+    }
+    profile.addCount("bytes", static_cast<std::int64_t>(bytes));
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include "StressIntervalIndex.h"
+
+// 解析済みのVTU（点・セル・ストレス配列）と応力区間インデックスを保存するバイナリキャッシュ
+// XMLの解析や展開を行わず、ファイルをメモリにマップしてそのままVTKの配列として使う
+//
+// キャッシュは元のVTUのパス（と応力の求め方を表す variant）ごとに1ファイルで、
+// 元ファイルのサイズと更新日時が一致する場合のみ使う
+// 書き出しは一時ファイルに行ってから rename で置き換えるため、読み込み中のプロセスには影響しない
+// キャッシュディレクトリは環境変数 STRECS3D_VTU_CACHE_DIR で変更でき、
+// STRECS3D_VTU_CACHE に "0" または "off" を指定すると無効になる
+// 圧縮なしの appended 形式のように元ファイルを直接読み込める場合は、応力区間インデックスのみを保存する
+// 書き出し後、キャッシュ全体が上限サイズ（既定 4GiB、環境変数 STRECS3D_VTU_CACHE_MAX_MB で変更できる）を
+// 超えた場合は、最も長く使われていないキャッシュから削除する
+class VtuBinaryCache {
+public:
+    static bool isEnabled();
+
+    // 元ファイルに対応するキャッシュがあれば、マップしたデータセットを返す（なければ nullptr）
+    // ストレス配列はアクティブスカラーに設定済みで、stressLabel にその名前を返す
+    static vtkSmartPointer<vtkUnstructuredGrid> read(const std::string& sourcePath, std::string& stressLabel,
+                                                     const std::string& variant = "");
+    // キャッシュ（インデックスのみのキャッシュを含む）の応力区間インデックスを読み込む（セル数が一致しない場合は false）
+    static bool readIndex(const std::string& sourcePath, vtkIdType cellCount, StressIntervalIndex& index,
+                          const std::string& variant = "");
+    // データセットとインデックスをキャッシュに書き出す（多面体セルを含むデータセットは対象外）
+    static bool write(const std::string& sourcePath, vtkUnstructuredGrid* grid, const std::string& stressLabel,
+                      const StressIntervalIndex& index, const std::string& variant = "");
+    // 応力区間インデックスのみをキャッシュに書き出す（read では使われず、readIndex でのみ読み込む）
+    static bool writeIndex(const std::string& sourcePath, const std::string& stressLabel,
+                           const StressIntervalIndex& index, const std::string& variant = "");
+
+    static std::filesystem::path getCachePath(const std::string& sourcePath, const std::string& variant = "");
+};
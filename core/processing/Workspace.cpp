@@ -0,0 +1,153 @@
+#include "Workspace.h"
+#include "../../utils/fileUtility.h"
+#include "../../utils/tempPathUtility.h"
+#include <QCoreApplication>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <system_error>
+
+const std::string Workspace::RESULT_3MF_PATH = "result/result.3mf";
+
+namespace {
+std::atomic<std::uint64_t> workspaceCounter{0};
+
+std::filesystem::path getWorkspaceBaseDir()
+{
+    const char* value = std::getenv("STRECS3D_WORKSPACE_ROOT");
+    if (value && *value) {
+        return std::filesystem::path(value);
+    }
+    return TempPathUtility::getTempDirPath() / "jobs";
+}
+
+// プロセスID・作成時刻・通し番号から、同時に実行される他の作業領域と重ならない名前を作る
+std::string makeWorkspaceName()
+{
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return "job-" + std::to_string(QCoreApplication::applicationPid()) + "-"
+        + std::to_string(now) + "-" + std::to_string(++workspaceCounter);
+}
+}
+
+std::shared_ptr<Workspace> Workspace::create()
+{
+    return create(getDefaultBackend());
+}
+
+std::shared_ptr<Workspace> Workspace::create(Backend backend)
+{
+    // ルートディレクトリは実際に使われるまで作成しない
+    return std::shared_ptr<Workspace>(new Workspace(backend, getWorkspaceBaseDir() / makeWorkspaceName()));
+}
+
+Workspace::Backend Workspace::getDefaultBackend()
+{
+    const char* value = std::getenv("STRECS3D_WORKSPACE_BACKEND");
+    if (value && std::string(value) == "memory") {
+        return Backend::Memory;
+    }
+    return Backend::Disk;
+}
+
+Workspace::Workspace(Backend backend, std::filesystem::path root)
+    : backend(backend), root(std::move(root))
+{
+}
+
+Workspace::~Workspace()
+{
+    if (rootCreated) {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        if (ec) {
+            std::cerr << "Failed to remove workspace " << root << ": " << ec.message() << std::endl;
+        }
+    }
+}
+
+bool Workspace::ensureDirectory(const std::filesystem::path& directory)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create directory: " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    rootCreated = true;
+    return true;
+}
+
+std::filesystem::path Workspace::getSubDirPath(const std::string& subDir)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::filesystem::path path = root / subDir;
+    ensureDirectory(path);
+    return path;
+}
+
+std::filesystem::path Workspace::getFilePath(const std::string& relativePath)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::filesystem::path path = root / relativePath;
+    ensureDirectory(path.parent_path());
+    return path;
+}
+
+bool Workspace::writeFile(const std::string& relativePath, std::vector<std::uint8_t> data)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (backend == Backend::Memory) {
+        memoryFiles[relativePath] = std::move(data);
+        return true;
+    }
+    const std::filesystem::path path = root / relativePath;
+    if (!ensureDirectory(path.parent_path())) {
+        return false;
+    }
+    if (!FileUtility::writeBytes(path, data)) {
+        std::cerr << "Failed to write workspace file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Workspace::readFile(const std::string& relativePath, std::vector<std::uint8_t>& data) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = memoryFiles.find(relativePath);
+    if (it != memoryFiles.end()) {
+        data = it->second;
+        return true;
+    }
+    return FileUtility::readBytes(root / relativePath, data);
+}
+
+bool Workspace::hasFile(const std::string& relativePath) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (memoryFiles.count(relativePath) > 0) {
+        return true;
+    }
+    std::error_code ec;
+    return std::filesystem::is_regular_file(root / relativePath, ec);
+}
+
+bool Workspace::exportFile(const std::string& relativePath, const std::filesystem::path& destination) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = memoryFiles.find(relativePath);
+    if (it != memoryFiles.end()) {
+        return FileUtility::writeBytes(destination, it->second);
+    }
+    std::error_code ec;
+    std::filesystem::copy_file(root / relativePath, destination,
+                               std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cerr << "Failed to export " << relativePath << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
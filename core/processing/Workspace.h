@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 処理1回分の作業領域
+// 実行ごとに独立したルートディレクトリを持つため、複数のパイプラインを同時に実行しても
+// 中間ファイルや出力が互いに上書きされない。破棄時にルートディレクトリごと削除する
+//
+// Memory バックエンドでは writeFile / readFile で扱うファイルをメモリ上に保持し、
+// ディスクへの書き込みを行わない（getFilePath など実ファイルが必要な場合のみディスクを使う）
+class Workspace {
+public:
+    enum class Backend {
+        Disk,
+        Memory
+    };
+
+    // 処理結果の3MFファイル（作業領域からの相対パス）
+    static const std::string RESULT_3MF_PATH;
+
+    // 既定のバックエンドで作成する
+    // 環境変数 STRECS3D_WORKSPACE_BACKEND に "memory" を指定するとメモリ上に保持する
+    static std::shared_ptr<Workspace> create();
+    // ルートディレクトリは一時ディレクトリ内の jobs/ に作成する
+    // 環境変数 STRECS3D_WORKSPACE_ROOT を指定した場合はその下に作成する（tmpfs などを指定できる）
+    static std::shared_ptr<Workspace> create(Backend backend);
+    static Backend getDefaultBackend();
+
+    ~Workspace();
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+    Backend getBackend() const { return backend; }
+    const std::filesystem::path& getRoot() const { return root; }
+
+    // 作業領域内のディレクトリ / ファイルのパスを取得する（必要なディレクトリは作成する）
+    std::filesystem::path getSubDirPath(const std::string& subDir);
+    std::filesystem::path getFilePath(const std::string& relativePath);
+
+    // ファイルの書き込み・読み込み（Memory バックエンドではディスクを使わない）
+    bool writeFile(const std::string& relativePath, std::vector<std::uint8_t> data);
+    bool readFile(const std::string& relativePath, std::vector<std::uint8_t>& data) const;
+    bool hasFile(const std::string& relativePath) const;
+
+    // 作業領域内のファイルを作業領域外の destination へ書き出す（既存のファイルは上書き）
+    bool exportFile(const std::string& relativePath, const std::filesystem::path& destination) const;
+
+private:
+    Workspace(Backend backend, std::filesystem::path root);
+
+    bool ensureDirectory(const std::filesystem::path& directory);
+
+    const Backend backend;
+    const std::filesystem::path root;
+    mutable std::mutex mutex;
+    bool rootCreated = false;
+    std::map<std::string, std::vector<std::uint8_t>> memoryFiles;
+};
@@ -1,6 +1,15 @@
 #include "lib3mfProcessor.h"
 #include "../../utils/xmlConverter.h"
 #include "../../utils/tempPathUtility.h"
+#include "ProcessControl.h"
+#include "Workspace.h"
+#include "DividedMesh.h"
+#include "../../utils/profiler.h"
+
+#include <vtkPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkTriangleFilter.h>
 
 #include <iostream>
 #include <filesystem>
@@ -8,12 +17,16 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <sstream>
+#include <cstdint>
 
 namespace fs = std::filesystem;
 
 
 bool Lib3mfProcessor::getMeshes(){
-    std::string directoryPath = TempPathUtility::getTempSubDirPath("div").string();
+    std::string directoryPath = workspace
+        ? workspace->getSubDirPath("div").string()
+        : TempPathUtility::getTempSubDirPath("div").string();
     try {
         // ディレクトリの存在確認
         fs::path dirPath(directoryPath);
@@ -112,11 +125,81 @@ bool Lib3mfProcessor::setStl(const std::string stlFileName){
     return true;
 }
 
+bool Lib3mfProcessor::addMesh(vtkPolyData* polyData, const std::string& meshName){
+    // 読み込み済みのポリゴンデータから直接メッシュを追加する（STLの再読み込みを行わない）
+    if (!polyData || polyData->GetNumberOfPoints() == 0) {
+        std::cerr << "No mesh data for " << meshName << std::endl;
+        return false;
+    }
+    if (processControl) processControl->throwIfCancelled();
+    Profiler::Scope profile("Convert mesh to 3MF");
+    std::cout << "adding " << meshName << "..." << std::endl;
+
+    // 三角形以外のポリゴンを含む場合は三角形に分割する
+    vtkSmartPointer<vtkPolyData> triangles = polyData;
+    if (polyData->GetPolys()->IsHomogeneous() != 3) {
+        vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+        triangleFilter->SetInputData(polyData);
+        triangleFilter->PassVertsOff();
+        triangleFilter->PassLinesOff();
+        triangleFilter->Update();
+        triangles = triangleFilter->GetOutput();
+    }
+
+    // 三角形から参照される頂点のみを詰めて出力する（表面抽出後は未使用の頂点が残るため）
+    const vtkIdType pointCount = triangles->GetNumberOfPoints();
+    std::vector<Lib3MF_uint32> vertexIndex(static_cast<size_t>(pointCount), UINT32_MAX);
+    std::vector<sPosition> vertices;
+    std::vector<sTriangle> faces;
+    faces.reserve(static_cast<size_t>(triangles->GetNumberOfPolys()));
+
+    auto iter = vtk::TakeSmartPointer(triangles->GetPolys()->NewIterator());
+    for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal(); iter->GoToNextCell()) {
+        vtkIdType npts;
+        const vtkIdType* pts;
+        iter->GetCurrentCell(npts, pts);
+        // 縮退した三角形は lib3mf で受け付けられないため除外する
+        if (npts != 3 || pts[0] == pts[1] || pts[1] == pts[2] || pts[0] == pts[2]) {
+            continue;
+        }
+        sTriangle face;
+        for (int k = 0; k < 3; ++k) {
+            Lib3MF_uint32& index = vertexIndex[pts[k]];
+            if (index == UINT32_MAX) {
+                double point[3];
+                triangles->GetPoint(pts[k], point);
+                sPosition position;
+                position.m_Coordinates[0] = static_cast<Lib3MF_single>(point[0]);
+                position.m_Coordinates[1] = static_cast<Lib3MF_single>(point[1]);
+                position.m_Coordinates[2] = static_cast<Lib3MF_single>(point[2]);
+                index = static_cast<Lib3MF_uint32>(vertices.size());
+                vertices.push_back(position);
+            }
+            face.m_Indices[k] = index;
+        }
+        faces.push_back(face);
+    }
+
+    try {
+        PMeshObject mesh = model->AddMeshObject();
+        mesh->SetGeometry(vertices, faces);
+        profile.addCount("triangles", static_cast<std::int64_t>(faces.size()));
+        mesh->SetName(meshName);
+
+        // STLリーダーで読み込んだ場合と同様にビルドアイテムとして登録する
+        sTransform identityTransform;
+        lib3mf_getidentitytransform(&identityTransform);
+        model->AddBuildItem(mesh.get(), identityTransform);
+    } catch (Lib3MF::ELib3MFException &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool Lib3mfProcessor::setMetaData(double maxStress, const std::vector<StressDensityMapping>& mappings) {
     auto meshIterator = model->GetMeshObjects();
-    std::regex filePattern(
-        R"(^dividedMesh(\d+)_(\d+(?:\.\d+)?)_(\d+(?:\.\d+)?)\.stl$)"
-    );
+    const std::regex filePattern(DIVIDED_MESH_NAME_PATTERN);
     for (; meshIterator->MoveNext(); ) {
         Lib3MF::PMeshObject currentMesh = meshIterator->GetCurrentMeshObject();
         auto name = currentMesh->GetName();
@@ -216,13 +299,69 @@ bool Lib3mfProcessor::save3mf(const std::string outputFilename){
         }
     }
     
-    PWriter writer = model->QueryWriter("3mf");
+    Profiler::Scope profile("Write 3MF");
+    PWriter writer = createWriter();
+
+    // 一時ファイルに書き出してから置き換え、中断や失敗時に書きかけのファイルを残さない
+    const std::string partialFilename = outputFilename + ".part";
     std::cout << "Writing " << outputFilename << "..." << std::endl;
-    writer->WriteToFile(outputFilename);
+    try {
+        writer->WriteToFile(partialFilename);
+        profile.addCount("bytes written", static_cast<std::int64_t>(std::filesystem::file_size(partialFilename)));
+        std::filesystem::rename(partialFilename, outputFilename);
+    } catch (const std::exception& e) {
+        std::error_code ec;
+        std::filesystem::remove(partialFilename, ec);
+        if (processControl) processControl->throwIfCancelled();
+        std::cerr << "Failed to write 3MF file: " << e.what() << std::endl;
+        return false;
+    }
     std::cout << "Done" << std::endl;
     return true;
 }
 
+bool Lib3mfProcessor::save3mf(Workspace& workspace, const std::string& relativePath){
+    if (workspace.getBackend() != Workspace::Backend::Memory) {
+        return save3mf(workspace.getFilePath(relativePath).string());
+    }
+
+    Profiler::Scope profile("Write 3MF");
+    PWriter writer = createWriter();
+    std::vector<Lib3MF_uint8> buffer;
+    std::cout << "Writing " << relativePath << " to memory..." << std::endl;
+    try {
+        writer->WriteToBuffer(buffer);
+    } catch (const std::exception& e) {
+        if (processControl) processControl->throwIfCancelled();
+        std::cerr << "Failed to write 3MF file: " << e.what() << std::endl;
+        return false;
+    }
+    profile.addCount("bytes written", static_cast<std::int64_t>(buffer.size()));
+    if (!workspace.writeFile(relativePath, std::move(buffer))) {
+        return false;
+    }
+    std::cout << "Done" << std::endl;
+    return true;
+}
+
+PWriter Lib3mfProcessor::createWriter(){
+    PWriter writer = model->QueryWriter("3mf");
+    if (processControl) {
+        writer->SetProgressCallback(&Lib3mfProcessor::onWriterProgress, processControl);
+    }
+    return writer;
+}
+
+void Lib3mfProcessor::onWriterProgress(bool* abort, Lib3MF_double progress, Lib3MF::eProgressIdentifier, Lib3MF_pvoid userData)
+{
+    ProcessControl* control = static_cast<ProcessControl*>(userData);
+    if (control->isCancelled()) {
+        // 書き出しを中断させる（WriteToFile は例外で戻る）
+        *abort = true;
+        return;
+    }
+    control->reportProgress(progress);
+}
 
 bool Lib3mfProcessor::setMetaDataBambu(double maxStress) {
     std::vector<StressDensityMapping> emptyMappings;
@@ -231,9 +370,7 @@ bool Lib3mfProcessor::setMetaDataBambu(double maxStress) {
 
 bool Lib3mfProcessor::setMetaDataBambu(double maxStress, const std::vector<StressDensityMapping>& mappings){
     auto meshIterator = model->GetMeshObjects();
-    std::regex filePattern(
-        R"(^dividedMesh(\d+)_(\d+(?:\.\d+)?)_(\d+(?:\.\d+)?)\.stl$)"
-    );
+    const std::regex filePattern(DIVIDED_MESH_NAME_PATTERN);
     for (; meshIterator->MoveNext(); ) {
         Lib3MF::PMeshObject currentMesh = meshIterator->GetCurrentMeshObject();
         auto name = currentMesh->GetName();
@@ -261,8 +398,7 @@ bool Lib3mfProcessor::setMetaDataBambu(double maxStress, const std::vector<Stres
     setPlateDataBambu(meshIterator->Count());
     setAssembleDataBambu(meshIterator->Count());
     setupBuildObjects();
-    exportConfig();
-    return true;
+    return exportConfig();
 }
 
 bool Lib3mfProcessor::setMetaDataForInfillMeshBambu(Lib3MF::PMeshObject Mesh, FileInfo fileInfo, double maxStress) {
@@ -382,19 +518,21 @@ bool Lib3mfProcessor::setupBuildObjects(){
 
 
 bool Lib3mfProcessor::exportConfig(){
-    // 出力先ディレクトリを指定
-    const std::string outputDir = TempPathUtility::getTempSubDirPath("3mf/Metadata").string();
-    // ディレクトリが存在しなければ作成する
-    std::filesystem::create_directories(outputDir);
-
-    // 出力ファイル名を設定
-    std::string outputFilename = outputDir + "/model_settings.config";
+    // Bambu用の設定ファイルを3MFパッケージ内の添付ファイルとして登録する
+    // （保存時に1回の書き込みでパッケージに含まれるため、展開・再圧縮が不要）
+    std::ostringstream oss;
+    xmlconverter::writeConfig(config, oss);
+    const std::string xml = oss.str();
+    std::vector<Lib3MF_uint8> buffer(xml.begin(), xml.end());
 
-    // XMLファイル "config.xml" に書き出し
-    if (xmlconverter::writeConfigToFile(config, outputFilename)) {
-        std::cout << "XMLファイル 'config.xml' に書き出しました。" << std::endl;
-    } else {
-        std::cerr << "XMLの書き出しに失敗しました。" << std::endl;
+    try {
+        model->AddCustomContentType("config", "text/xml");
+        PAttachment attachment = model->AddAttachment(BAMBU_CONFIG_PATH, BAMBU_CONFIG_RELATIONSHIP);
+        attachment->ReadFromBuffer(buffer);
+    } catch (Lib3MF::ELib3MFException &e) {
+        std::cerr << "Failed to attach model_settings.config: " << e.what() << std::endl;
+        return false;
     }
+    std::cout << "Attached " << BAMBU_CONFIG_PATH << " to the 3MF package." << std::endl;
     return true;
-}
\ No newline at end of file
+}
@@ -4,9 +4,15 @@
 #include "lib3mf_implicit.hpp"
 using namespace Lib3MF;
 
+class vtkPolyData;
+class ProcessControl;
+class Workspace;
+
 #include "../../utils/xmlConverter.h"
 #include <vector>
-#include "../../UI/widgets/DensitySlider.h" // For StressDensityMapping
+#include <string>
+#include <vtkSmartPointer.h>
+#include "StressDensityMapping.h"
 
 struct FileInfo {
     int id;
@@ -17,18 +23,33 @@ struct FileInfo {
 
 class Lib3mfProcessor{
     private:
+        // Bambu Studio が読み込む設定ファイルのパッケージ内パスとリレーションシップ
+        static constexpr const char* BAMBU_CONFIG_PATH = "/Metadata/model_settings.config";
+        static constexpr const char* BAMBU_CONFIG_RELATIONSHIP = "http://schemas.bambulab.com/package/2021/model-settings";
+
         PWrapper wrapper = CWrapper::loadLibrary();
         PModel model = wrapper->CreateModel();
         PReader reader = model->QueryReader("stl"); 
 
         xmlconverter::Config config;
         xmlconverter::Object object;
+        ProcessControl* processControl = nullptr;
+        Workspace* workspace = nullptr;
+
+        PWriter createWriter();
+        static void onWriterProgress(bool* abort, Lib3MF_double progress, Lib3MF::eProgressIdentifier identifier, Lib3MF_pvoid userData);
     public:
+        void setProcessControl(ProcessControl* control) { processControl = control; }
+        // 中間ファイルを読み書きする作業領域（未設定の場合は共有の一時ディレクトリ）
+        void setWorkspace(Workspace* workspace) { this->workspace = workspace; }
         bool getMeshes();
         bool setStl(const std::string stlFileName);
+        bool addMesh(vtkPolyData* polyData, const std::string& meshName);
         bool setMetaData(double maxStress);
         bool setMetaData(double maxStress, const std::vector<StressDensityMapping>& mappings);
         bool save3mf(const std::string outputFilename);
+        // 作業領域内の relativePath へ書き出す（Memory バックエンドではメモリ上に書き出す）
+        bool save3mf(Workspace& workspace, const std::string& relativePath);
         bool setMetaDataForInfillMesh(Lib3MF::PMeshObject Mesh, FileInfo fileInfo, double maxStress);
         bool setMetaDataForInfillMesh(Lib3MF::PMeshObject Mesh, FileInfo fileInfo, double maxStress, const std::vector<StressDensityMapping>& mappings);
         bool setMetaDataForOutlineMesh(Lib3MF::PMeshObject Mesh);
@@ -1,6 +1,5 @@
 #include "SceneDataController.h"
 #include "../processing/VtkProcessor.h"
-#include "../../utils/tempPathUtility.h"
 #include <regex>
 #include <algorithm>
 #include <filesystem>
@@ -43,13 +42,13 @@ void SceneDataController::setObjectOpacity(const std::string& filename, double o
 }
 
 void SceneDataController::removeDividedStlActors() {
-    std::regex dividedStlPattern(R"(dividedMesh\d+_[-0-9.]+_[-0-9.]+\.stl$)");
+    const std::regex dividedStlPattern(DIVIDED_MESH_NAME_PATTERN);
     
     objectList_.erase(
         std::remove_if(
             objectList_.begin(), objectList_.end(),
             [&](const ObjectInfo& obj) {
-                return std::regex_search(obj.filename, dividedStlPattern);
+                return std::regex_match(std::filesystem::path(obj.filename).filename().string(), dividedStlPattern);
             }
         ),
         objectList_.end()
@@ -67,6 +66,7 @@ void SceneDataController::hideAllStlObjects() {
 void SceneDataController::hideVtkObject() {
     for (const auto& obj : objectList_) {
         if ((obj.filename.size() >= 4 && obj.filename.substr(obj.filename.size() - 4) == ".vtu") ||
+            (obj.filename.size() >= 5 && obj.filename.substr(obj.filename.size() - 5) == ".pvtu") ||
             (obj.filename.size() >= 4 && obj.filename.substr(obj.filename.size() - 4) == ".vtk")) {
             const_cast<SceneDataController*>(this)->setObjectVisible(obj.filename, false);
         }
@@ -86,6 +86,7 @@ std::vector<std::string> SceneDataController::getAllStlFilenames() const {
 std::string SceneDataController::getVtkFilename() const {
     for (const auto& obj : objectList_) {
         if ((obj.filename.size() >= 4 && obj.filename.substr(obj.filename.size() - 4) == ".vtu") ||
+            (obj.filename.size() >= 5 && obj.filename.substr(obj.filename.size() - 5) == ".pvtu") ||
             (obj.filename.size() >= 4 && obj.filename.substr(obj.filename.size() - 4) == ".vtk")) {
             return obj.filename;
         }
@@ -97,20 +98,12 @@ const std::vector<ObjectInfo>& SceneDataController::getObjectList() const {
     return objectList_;
 }
 
-std::vector<std::pair<std::filesystem::path, int>> SceneDataController::fetchDividedStlFiles() {
-    std::filesystem::path tempDir = TempPathUtility::getTempSubDirPath("div");
-    if (!std::filesystem::exists(tempDir)) {
-        throw std::runtime_error(".temp directory does not exist");
-    }
-    return sortStlFiles(tempDir);
-}
-
 std::optional<std::pair<double, double>> SceneDataController::parseStressRange(const std::string& filename) {
-    std::regex stressPattern(R"(^dividedMesh\d+_([0-9.]+)_([0-9.]+)\.stl$)");
+    const std::regex stressPattern(DIVIDED_MESH_NAME_PATTERN);
     std::smatch match;
-    if (std::regex_search(filename, match, stressPattern)) {
-        double stressMin = std::stod(match[1].str());
-        double stressMax = std::stod(match[2].str());
+    if (std::regex_match(filename, match, stressPattern)) {
+        double stressMin = std::stod(match[2].str());
+        double stressMax = std::stod(match[3].str());
         return std::make_pair(stressMin, stressMax);
     }
     return std::nullopt;
@@ -126,27 +119,27 @@ vtkSmartPointer<vtkActor> SceneDataController::loadStlFile(const std::string& st
     return vtkProcessor->getStlActor(stlFile);
 }
 
-std::vector<vtkSmartPointer<vtkActor>> SceneDataController::loadDividedStlFiles(
-    const std::vector<std::pair<std::filesystem::path, int>>& stlFiles,
+std::vector<vtkSmartPointer<vtkActor>> SceneDataController::loadDividedMeshes(
+    const std::vector<DividedMesh>& meshes,
     VtkProcessor* vtkProcessor,
     double minStress,
     double maxStress) {
     
     std::vector<vtkSmartPointer<vtkActor>> actors;
     
-    for (const auto& [path, number] : stlFiles) {
-        std::string filename = path.filename().string();
+    for (const auto& mesh : meshes) {
         vtkSmartPointer<vtkActor> actor = nullptr;
         
-        if (auto stressValues = parseStressRange(filename)) {
-            actor = createStlActorWithStress(path, *stressValues, minStress, maxStress, vtkProcessor);
+        if (auto stressValues = parseStressRange(mesh.name)) {
+            actor = createStlActorWithStress(mesh.polyData, *stressValues, minStress, maxStress, vtkProcessor);
         } else {
-            actor = createStlActorWithColor(path, number, stlFiles.size(), vtkProcessor);
+            actor = createStlActorWithColor(mesh.polyData, mesh.number, meshes.size(), vtkProcessor);
         }
         
+        // 表示できないメッシュも、ウィジェットとの対応を保つため nullptr のまま返す
+        actors.push_back(actor);
         if (actor) {
-            actors.push_back(actor);
-            ObjectInfo objInfo{actor, path.string(), true, 1.0};
+            ObjectInfo objInfo{actor, mesh.name, true, 1.0};
             registerObject(objInfo);
         }
     }
@@ -154,27 +147,6 @@ std::vector<vtkSmartPointer<vtkActor>> SceneDataController::loadDividedStlFiles(
     return actors;
 }
 
-std::vector<std::pair<std::filesystem::path, int>> SceneDataController::sortStlFiles(const std::filesystem::path& tempDir) {
-    std::vector<std::pair<std::filesystem::path, int>> stlFiles;
-    std::regex filePattern(R"(^dividedMesh(\d+)_)");
-    
-    for (const auto& entry : std::filesystem::directory_iterator(tempDir)) {
-        if (entry.path().extension() == ".stl") {
-            std::string filename = entry.path().filename().string();
-            std::smatch match;
-            if (std::regex_search(filename, match, filePattern)) {
-                int number = std::stoi(match[1].str());
-                stlFiles.push_back({entry.path(), number});
-            }
-        }
-    }
-    
-    std::sort(stlFiles.begin(), stlFiles.end(),
-        [](const auto& a, const auto& b) { return a.second < b.second; });
-    
-    return stlFiles;
-}
-
 void SceneDataController::calculateColor(double normalizedPos, double& r, double& g, double& b) {
     if (normalizedPos <= 0.5) {
         double t = normalizedPos * 2.0;
@@ -190,18 +162,18 @@ void SceneDataController::calculateColor(double normalizedPos, double& r, double
 }
 
 vtkSmartPointer<vtkActor> SceneDataController::createStlActorWithStress(
-    const std::filesystem::path& path,
+    vtkPolyData* polyData,
     const std::pair<double, double>& stressValues,
     double minStress,
     double maxStress,
     VtkProcessor* vtkProcessor) {
     
     double stressValue = (stressValues.first + stressValues.second) / 2.0;
-    return vtkProcessor->getColoredStlActorByStress(path.string(), stressValue, minStress, maxStress);
+    return vtkProcessor->getColoredStlActorByStress(polyData, stressValue, minStress, maxStress);
 }
 
 vtkSmartPointer<vtkActor> SceneDataController::createStlActorWithColor(
-    const std::filesystem::path& path,
+    vtkPolyData* polyData,
     int number,
     size_t totalFiles,
     VtkProcessor* vtkProcessor) {
@@ -209,5 +181,5 @@ vtkSmartPointer<vtkActor> SceneDataController::createStlActorWithColor(
     double r, g, b;
     double normalizedPos = static_cast<double>(number) / totalFiles;
     calculateColor(normalizedPos, r, g, b);
-    return vtkProcessor->getColoredStlActor(path.string(), r, g, b);
+    return vtkProcessor->getColoredStlActor(polyData, r, g, b);
 }
\ No newline at end of file
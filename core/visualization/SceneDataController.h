@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <vtkSmartPointer.h>
 #include <vtkActor.h>
+#include <vtkPolyData.h>
+#include "../processing/DividedMesh.h"
 
 struct ObjectInfo {
     vtkSmartPointer<vtkActor> actor;
@@ -36,17 +38,16 @@ public:
     std::string getVtkFilename() const;
     const std::vector<ObjectInfo>& getObjectList() const;
     
-    // STL分割ファイル処理
-    std::vector<std::pair<std::filesystem::path, int>> fetchDividedStlFiles();
+    // 分割メッシュ処理
     std::optional<std::pair<double, double>> parseStressRange(const std::string& filename);
     
     // VTKファイル処理
     vtkSmartPointer<vtkActor> loadVtkFile(const std::string& vtkFile, VtkProcessor* vtkProcessor);
     vtkSmartPointer<vtkActor> loadStlFile(const std::string& stlFile, VtkProcessor* vtkProcessor);
     
-    // 分割STLファイル処理
-    std::vector<vtkSmartPointer<vtkActor>> loadDividedStlFiles(
-        const std::vector<std::pair<std::filesystem::path, int>>& stlFiles,
+    // 分割メッシュ（メモリ上のポリゴンデータ）からActorを作成
+    std::vector<vtkSmartPointer<vtkActor>> loadDividedMeshes(
+        const std::vector<DividedMesh>& meshes,
         VtkProcessor* vtkProcessor,
         double minStress,
         double maxStress);
@@ -54,16 +55,15 @@ public:
 private:
     std::vector<ObjectInfo> objectList_;
     
-    std::vector<std::pair<std::filesystem::path, int>> sortStlFiles(const std::filesystem::path& tempDir);
     void calculateColor(double normalizedPos, double& r, double& g, double& b);
     vtkSmartPointer<vtkActor> createStlActorWithStress(
-        const std::filesystem::path& path,
+        vtkPolyData* polyData,
         const std::pair<double, double>& stressValues,
         double minStress,
         double maxStress,
         VtkProcessor* vtkProcessor);
     vtkSmartPointer<vtkActor> createStlActorWithColor(
-        const std::filesystem::path& path,
+        vtkPolyData* polyData,
         int number,
         size_t totalFiles,
         VtkProcessor* vtkProcessor);
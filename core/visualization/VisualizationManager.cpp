@@ -54,24 +54,22 @@ void VisualizationManager::displayStlFile(const std::string& stlFile, VtkProcess
     }
 }
 
-void VisualizationManager::showTempDividedStl(VtkProcessor* vtkProcessor, QWidget* parent) {
+void VisualizationManager::showDividedMeshes(const std::vector<DividedMesh>& meshes, VtkProcessor* vtkProcessor, QWidget* parent) {
     try {
-        auto stlFiles = dataController_->fetchDividedStlFiles();
-        if (stlFiles.empty()) {
-            throw std::runtime_error("No valid STL files found");
+        if (meshes.empty()) {
+            throw std::runtime_error("No divided meshes to display");
         }
         double minStress = vtkProcessor->getMinStress();
         double maxStress = vtkProcessor->getMaxStress();
         auto widgets = renderer_->fetchMeshDisplayWidgets();
         
-        auto actors = dataController_->loadDividedStlFiles(stlFiles, vtkProcessor, minStress, maxStress);
+        auto actors = dataController_->loadDividedMeshes(meshes, vtkProcessor, minStress, maxStress);
         
         int widgetIndex = 0;
-        for (size_t i = 0; i < stlFiles.size() && i < actors.size(); ++i) {
-            const auto& [path, number] = stlFiles[i];
-            std::string filename = path.filename().string();
+        for (size_t i = 0; i < meshes.size() && i < actors.size(); ++i) {
+            if (!actors[i]) continue;
             renderer_->addActorToRenderer(actors[i]);
-            renderer_->updateWidgetAndConnectSignals(widgets, widgetIndex, filename, path.string());
+            renderer_->updateWidgetAndConnectSignals(widgets, widgetIndex, meshes[i].name, meshes[i].name);
         }
         
         renderer_->resetCamera();
@@ -112,6 +110,18 @@ void VisualizationManager::hideVtkObject() {
     renderer_->renderObjects(dataController_->getObjectList());
 }
 
+void VisualizationManager::showBandPreview(VtkProcessor* vtkProcessor, const std::vector<double>& thresholds) {
+    if (!vtkProcessor || !vtkProcessor->getCurrentLookupTable()) return;
+    vtkProcessor->setBandPreview(thresholds);
+    renderer_->render();
+}
+
+void VisualizationManager::hideBandPreview(VtkProcessor* vtkProcessor) {
+    if (!vtkProcessor || !vtkProcessor->isBandPreviewEnabled()) return;
+    vtkProcessor->clearBandPreview();
+    renderer_->render();
+}
+
 std::vector<std::string> VisualizationManager::getAllStlFilenames() const {
     return dataController_->getAllStlFilenames();
 }
@@ -4,6 +4,8 @@
 #include <QWidget>
 #include <string>
 #include <memory>
+#include <vector>
+#include "../processing/DividedMesh.h"
 
 class MainWindowUI;
 class VtkProcessor;
@@ -20,7 +22,7 @@ public:
     // ファイル表示
     void displayVtkFile(const std::string& vtkFile, VtkProcessor* vtkProcessor);
     void displayStlFile(const std::string& stlFile, VtkProcessor* vtkProcessor);
-    void showTempDividedStl(VtkProcessor* vtkProcessor, QWidget* parent = nullptr);
+    void showDividedMeshes(const std::vector<DividedMesh>& meshes, VtkProcessor* vtkProcessor, QWidget* parent = nullptr);
 
     // オブジェクト制御
     void setObjectVisible(const std::string& filename, bool visible);
@@ -28,6 +30,8 @@ public:
     void removeDividedStlActors();
     void hideAllStlObjects();
     void hideVtkObject();
+    void showBandPreview(VtkProcessor* vtkProcessor, const std::vector<double>& thresholds);
+    void hideBandPreview(VtkProcessor* vtkProcessor);
     
     // ファイル情報取得
     std::vector<std::string> getAllStlFilenames() const;
@@ -30,6 +30,10 @@ MainWindow::MainWindow(QWidget* parent)
     connect(ui->getOpenVtkButton(), &QPushButton::clicked, this, &MainWindow::openVTKFile);
     connect(ui->getProcessButton(), &QPushButton::clicked, this, &MainWindow::processFiles);
     connect(ui->getExport3mfButton(), &QPushButton::clicked, this, &MainWindow::export3mfFile);
+
+    // ハンドルのドラッグ中はカラーテーブルのみを更新してバンド境界をプレビューする
+    connect(ui->getBandPreviewCheckBox(), &QCheckBox::toggled, this, &MainWindow::onBandPreviewToggled);
+    connect(ui->getRangeSlider(), &DensitySlider::handlePositionsChanged, this, &MainWindow::onDensityHandlesChanged);
     
     // ObjectDisplayOptionsWidgetのシグナルをVisualizationManagerに接続
     auto objectDisplayWidget = ui->getObjectDisplayOptionsWidget();
@@ -61,17 +65,26 @@ MainWindow::~MainWindow() = default;
 
 void MainWindow::openVTKFile()
 {
-    QString fileName = QFileDialog::getOpenFileName(this,
-                                                    "Open VTK File",
-                                                    "",
-                                                    "VTK Files (*.vtu)");
-    if (fileName.isEmpty())
+    // 同じメッシュの複数の荷重ケースを選択した場合は、最初のファイルを基準に包絡値を表示・分割する
+    QStringList fileNames = QFileDialog::getOpenFileNames(this,
+                                                          "Open VTK File",
+                                                          "",
+                                                          "VTK Files (*.vtu *.pvtu)");
+    if (fileNames.isEmpty())
         return;
         
+    QString fileName = fileNames.takeFirst();
     std::string vtkFile = fileName.toStdString();
+    std::vector<std::string> loadCaseFiles;
+    for (const QString& loadCase : fileNames) {
+        loadCaseFiles.push_back(loadCase.toStdString());
+    }
     logMessage("Open VTK File: " + fileName);
+    if (!loadCaseFiles.empty()) {
+        logMessage(QString("Load cases: %1 files (max envelope)").arg(fileNames.size() + 1));
+    }
     
-    if (appController->openVtkFile(vtkFile, uiAdapter.get())) {
+    if (appController->openVtkFile(vtkFile, uiAdapter.get(), loadCaseFiles)) {
         logMessage("VTK file loaded successfully");
     } else {
         logMessage("Failed to load VTK file");
@@ -100,15 +113,71 @@ void MainWindow::openSTLFile()
 
 void MainWindow::processFiles()
 {
+    // 処理中はボタンがキャンセルとして動作する
+    if (appController->isProcessing()) {
+        logMessage("Cancelling file processing...");
+        appController->cancelProcessing();
+        return;
+    }
+
     logMessage("Starting file processing...");
+    lastProgressStage.clear();
     
     if (appController->processFiles(uiAdapter.get())) {
+        setProcessingState(true);
+    } else {
+        logMessage("File processing failed");
+    }
+}
+
+void MainWindow::onProcessingProgress(const QString& stage, int percent)
+{
+    if (stage != lastProgressStage) {
+        lastProgressStage = stage;
+        logMessage(stage + "...");
+    }
+    ui->getProcessButton()->setText(QString("Cancel (%1%)").arg(percent));
+}
+
+void MainWindow::onProcessingFinished(bool success, bool cancelled)
+{
+    setProcessingState(false);
+    if (success) {
         logMessage("File processing completed successfully");
+    } else if (cancelled) {
+        logMessage("File processing cancelled");
     } else {
         logMessage("File processing failed");
     }
 }
 
+void MainWindow::onProcessingReport(const QString& report)
+{
+    // 段階ごとの計測結果を1行ずつ表示する
+    for (const QString& line : report.split('\n', Qt::SkipEmptyParts)) {
+        logMessage(line);
+    }
+}
+
+void MainWindow::onBandPreviewToggled(bool enabled)
+{
+    appController->setBandPreviewEnabled(enabled, uiAdapter.get());
+}
+
+void MainWindow::onDensityHandlesChanged()
+{
+    appController->updateBandPreview(uiAdapter.get());
+    appController->scheduleSpeculativeDivision(uiAdapter.get());
+}
+
+void MainWindow::setProcessingState(bool processing)
+{
+    ui->getProcessButton()->setText(processing ? "Cancel" : "Process");
+    ui->getOpenVtkButton()->setEnabled(!processing);
+    ui->getOpenStlButton()->setEnabled(!processing);
+    ui->getExport3mfButton()->setEnabled(!processing);
+}
+
 void MainWindow::export3mfFile()
 {
     logMessage("Starting 3MF export...");
@@ -220,4 +289,14 @@ void MainWindow::setupSignalSlotConnections()
     
     connect(appController.get(), &ApplicationController::showInfoMessage,
             uiAdapter.get(), &IUserInterface::onShowInfoMessage);
+    
+    // 非同期処理の進捗・完了通知
+    connect(appController.get(), &ApplicationController::processingProgress,
+            this, &MainWindow::onProcessingProgress);
+    
+    connect(appController.get(), &ApplicationController::processingFinished,
+            this, &MainWindow::onProcessingFinished);
+    
+    connect(appController.get(), &ApplicationController::processingReport,
+            this, &MainWindow::onProcessingReport);
 }
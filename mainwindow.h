@@ -34,13 +34,20 @@ public slots:
     void onObjectOpacityChanged(double opacity);
     void onVtkObjectVisibilityChanged(bool visible);
     void onVtkObjectOpacityChanged(double opacity);
+    void onProcessingProgress(const QString& stage, int percent);
+    void onProcessingFinished(bool success, bool cancelled);
+    void onProcessingReport(const QString& report);
+    void onBandPreviewToggled(bool enabled);
+    void onDensityHandlesChanged();
 
 private:
     void setupSignalSlotConnections();
+    void setProcessingState(bool processing);
     
     std::unique_ptr<ApplicationController> appController;
     std::unique_ptr<MainWindowUI> ui;
     std::unique_ptr<MainWindowUIAdapter> uiAdapter;
+    QString lastProgressStage;
 };
 
 #endif // MAINWINDOW_H
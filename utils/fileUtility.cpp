@@ -199,4 +199,24 @@ bool FileUtility::clearDirectoryContents(const std::filesystem::path& dir) {
         }
     }
     return true;
-}
\ No newline at end of file
+}
+
+bool FileUtility::readBytes(const std::filesystem::path& path, std::vector<std::uint8_t>& data) {
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) {
+        return false;
+    }
+    const std::streamsize size = stream.tellg();
+    stream.seekg(0);
+    data.resize(static_cast<size_t>(size));
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(data.data()), size));
+}
+
+bool FileUtility::writeBytes(const std::filesystem::path& path, const std::vector<std::uint8_t>& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return false;
+    }
+    stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(stream);
+}
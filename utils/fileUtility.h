@@ -3,6 +3,8 @@
 
 #include <string>
 #include <filesystem>
+#include <cstdint>
+#include <vector>
 
 class FileUtility {
 public:
@@ -19,6 +21,18 @@ public:
     static bool unzipFile(const std::string& zipFilePath, const std::string& extractToDirectory);
     static bool clearDirectoryContents(const std::filesystem::path& dir);
 
+    /// @brief ファイルの内容をすべてバイナリで読み込みます。
+    /// @param path 読み込むファイルのパス
+    /// @param data 読み込んだ内容
+    /// @return 読み込みに成功した場合は true、失敗した場合は false
+    static bool readBytes(const std::filesystem::path& path, std::vector<std::uint8_t>& data);
+
+    /// @brief data をバイナリでファイルに書き出します（既存のファイルは上書きします）。
+    /// @param path 書き出すファイルのパス
+    /// @param data 書き出す内容
+    /// @return 書き出しに成功した場合は true、失敗した場合は false
+    static bool writeBytes(const std::filesystem::path& path, const std::vector<std::uint8_t>& data);
+
 };
 
 #endif // ZIPUTILITY_H
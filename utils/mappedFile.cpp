@@ -0,0 +1,75 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#ifdef _WIN32
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(static_cast<size_t>(wideLength > 0 ? wideLength - 1 : 0), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), wideLength);
+    HANDLE handle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    file->fileHandle = handle;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    file->mappingHandle = mapping;
+    void* address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!address) {
+        return nullptr;
+    }
+    file->address = static_cast<std::uint8_t*>(address);
+    file->length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        ::close(descriptor);
+        return nullptr;
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         descriptor, 0);
+    // マップはファイルディスクリプタを閉じた後も有効
+    ::close(descriptor);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    file->address = static_cast<std::uint8_t*>(address);
+    file->length = static_cast<size_t>(status.st_size);
+#endif
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (address) UnmapViewOfFile(address);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+#else
+    if (address) munmap(address, length);
+#endif
+}
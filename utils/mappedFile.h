@@ -0,0 +1,38 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class MappedFile {
+public:
+    /// @brief ファイル全体をメモリにマップします。
+    /// マップはコピーオンライト（書き込みはプロセス内にのみ反映され、ファイルは変更されない）で作成します。
+    /// @param path マップするファイルのパス
+    /// @return 成功した場合はマップ、失敗した場合（空のファイルを含む）は nullptr
+    static std::shared_ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief マップされた先頭アドレスを取得します。
+    std::uint8_t* data() const { return address; }
+
+    /// @brief マップされたバイト数を取得します。
+    size_t size() const { return length; }
+
+private:
+    MappedFile() = default;
+
+    std::uint8_t* address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_H
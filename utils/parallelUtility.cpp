@@ -0,0 +1,99 @@
+#include "parallelUtility.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<unsigned int> configuredWorkerCount{0};
+// parallelFor の処理中のスレッドに割り当てられたスレッド数（0 の場合は並列処理の外）
+thread_local unsigned int regionWorkerBudget = 0;
+}
+
+unsigned int ParallelUtility::getWorkerCount() {
+    if (regionWorkerBudget > 0) {
+        return regionWorkerBudget;
+    }
+    unsigned int count = configuredWorkerCount.load();
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return count;
+}
+
+void ParallelUtility::setWorkerCount(unsigned int count) {
+    configuredWorkerCount.store(count);
+}
+
+void ParallelUtility::parallelFor(size_t count, const std::function<void(size_t)>& func) {
+    parallelFor(count, 0, func);
+}
+
+void ParallelUtility::parallelFor(size_t count, unsigned int workerCount, const std::function<void(size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+
+    const unsigned int available = getWorkerCount();
+    const bool explicitCount = workerCount != 0;
+    if (!explicitCount) {
+        workerCount = available;
+    }
+    size_t threadCount = std::min<size_t>(count, workerCount);
+    if (threadCount <= 1) {
+        // 並列化の必要がない場合は呼び出しスレッドでそのまま実行
+        for (size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{0};
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+
+    // 入れ子の並列処理が使うスレッド数（明示した場合は外側のループのみの並列数のため、内側には既定値を渡す）
+    const unsigned int innerBudget = explicitCount
+        ? available
+        : std::max(1u, available / static_cast<unsigned int>(threadCount));
+    // ワーカースレッドの計測区間は呼び出し元と同じセッションに記録する
+    const Profiler::SessionPtr session = Profiler::getCurrentSession();
+    auto worker = [&]() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+    };
+
+    // 呼び出しスレッドもワーカーの一つとして利用する
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t t = 0; t + 1 < threadCount; ++t) {
+        threads.emplace_back([&]() {
+            Profiler::setCurrentSession(session);
+            regionWorkerBudget = innerBudget;
+            worker();
+        });
+    }
+    const unsigned int callerBudget = regionWorkerBudget;
+    regionWorkerBudget = innerBudget;
+    worker();
+    regionWorkerBudget = callerBudget;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
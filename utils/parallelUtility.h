@@ -0,0 +1,36 @@
+#ifndef PARALLELUTILITY_H
+#define PARALLELUTILITY_H
+
+#include <cstddef>
+#include <functional>
+
+class ParallelUtility {
+public:
+    /// @brief 並列処理に使用するワーカースレッド数を取得します。
+    /// parallelFor の処理中に呼び出した場合は、そのスレッドに割り当てられたスレッド数を返します。
+    /// @return 設定値（未設定の場合はハードウェアスレッド数）
+    static unsigned int getWorkerCount();
+
+    /// @brief 並列処理に使用するワーカースレッド数を設定します。
+    /// @param count ワーカー数（0 の場合はハードウェアスレッド数を使用）
+    static void setWorkerCount(unsigned int count);
+
+    /// @brief [0, count) の各インデックスに対して func を並列に実行します。
+    /// 結果はインデックスごとに書き込むことで、実行順序に依存しない出力になります。
+    /// いずれかの呼び出しで例外が発生した場合は、全スレッドの終了後に最初の例外を再送出します。
+    /// func の中から入れ子で呼び出した場合は、外側のスレッド数で割った残りのスレッド数で実行します
+    /// （外側がすべてのスレッドを使っている場合は呼び出しスレッドのみで実行し、スレッド数の過剰を避けます）。
+    /// @param count 処理するインデックスの数
+    /// @param func 各インデックスに対して呼び出される関数
+    static void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+    /// @brief ワーカー数を明示して [0, count) の各インデックスに対して func を並列に実行します。
+    /// 内側の処理が既定のワーカー数で並列化される場合に、外側のループの並列数を個別に指定するために使用します。
+    /// func の中の並列処理には、呼び出し元のスレッド数（getWorkerCount() の値）がそのまま割り当てられます。
+    /// @param count 処理するインデックスの数
+    /// @param workerCount 使用するスレッド数（0 の場合は getWorkerCount() の値）
+    /// @param func 各インデックスに対して呼び出される関数
+    static void parallelFor(size_t count, unsigned int workerCount, const std::function<void(size_t)>& func);
+};
+
+#endif // PARALLELUTILITY_H
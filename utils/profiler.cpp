@@ -0,0 +1,266 @@
+#include "profiler.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+class Profiler::Session {
+public:
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::vector<Record> records;
+};
+
+namespace {
+std::atomic<bool> profilerEnabled{true};
+thread_local Profiler::SessionPtr currentSession;
+thread_local int scopeDepth = 0;
+
+// スレッドの通し番号は終了したスレッドのものを小さい順に再利用する
+// （並列処理のたびにスレッドを作成するため、使い捨てにすると番号が増え続ける）
+std::mutex threadIndexMutex;
+std::set<int> freeThreadIndices;
+int nextThreadIndex = 1;
+
+struct ThreadIndexSlot {
+    int index = 0;
+    ~ThreadIndexSlot()
+    {
+        if (index != 0) {
+            std::lock_guard<std::mutex> lock(threadIndexMutex);
+            freeThreadIndices.insert(index);
+        }
+    }
+};
+thread_local ThreadIndexSlot threadIndexSlot;
+
+int currentThreadIndex()
+{
+    if (threadIndexSlot.index == 0) {
+        std::lock_guard<std::mutex> lock(threadIndexMutex);
+        if (freeThreadIndices.empty()) {
+            threadIndexSlot.index = nextThreadIndex++;
+        } else {
+            threadIndexSlot.index = *freeThreadIndices.begin();
+            freeThreadIndices.erase(freeThreadIndices.begin());
+        }
+    }
+    return threadIndexSlot.index;
+}
+
+std::string escapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::ostringstream oss;
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+                escaped += oss.str();
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+}
+
+Profiler::Scope::Scope(const char* name)
+    : wallStart(std::chrono::steady_clock::now())
+    , cpuStartMs(0.0)
+    , peakRssStart(0)
+{
+    if (!isEnabled() || !currentSession) return;
+    session = currentSession;
+    record.name = name;
+    record.threadIndex = currentThreadIndex();
+    record.depth = scopeDepth++;
+    record.startUs = std::chrono::duration<double, std::micro>(wallStart - session->start).count();
+    cpuStartMs = getProcessCpuTimeMs();
+    peakRssStart = getPeakRssBytes();
+}
+
+Profiler::Scope::~Scope()
+{
+    if (record.name.empty()) return;
+    --scopeDepth;
+    record.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    record.cpuMs = getProcessCpuTimeMs() - cpuStartMs;
+    record.peakRssDeltaBytes = static_cast<std::int64_t>(getPeakRssBytes() - peakRssStart);
+
+    std::lock_guard<std::mutex> lock(session->mutex);
+    session->records.push_back(std::move(record));
+}
+
+void Profiler::Scope::addCount(const char* key, std::int64_t value)
+{
+    if (record.name.empty()) return;
+    for (auto& count : record.counts) {
+        if (count.first == key) {
+            count.second += value;
+            return;
+        }
+    }
+    record.counts.emplace_back(key, value);
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    profilerEnabled.store(enabled);
+}
+
+bool Profiler::isEnabled()
+{
+    return profilerEnabled.load();
+}
+
+void Profiler::beginSession()
+{
+    currentSession = std::make_shared<Session>();
+}
+
+std::vector<Profiler::Record> Profiler::takeRecords()
+{
+    std::vector<Record> records;
+    if (currentSession) {
+        std::lock_guard<std::mutex> lock(currentSession->mutex);
+        records.swap(currentSession->records);
+    }
+    // 記録は終了順に追加されるため、開始順に並べ替える
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.startUs < b.startUs;
+    });
+    return records;
+}
+
+Profiler::SessionPtr Profiler::getCurrentSession()
+{
+    return currentSession;
+}
+
+void Profiler::setCurrentSession(SessionPtr session)
+{
+    currentSession = std::move(session);
+}
+
+std::string Profiler::formatSummary(const std::vector<Record>& records)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    // スレッド番号は再利用されるため、最初の区間（セッションを開始したスレッド）以外のみ表示する
+    const int mainThreadIndex = records.empty() ? 0 : records.front().threadIndex;
+    for (const auto& record : records) {
+        oss << std::string(record.depth * 2, ' ') << record.name
+            << ": wall " << record.wallMs << " ms"
+            << ", cpu " << record.cpuMs << " ms"
+            << ", peak RSS +" << (record.peakRssDeltaBytes / (1024.0 * 1024.0)) << " MB";
+        if (record.threadIndex != mainThreadIndex) {
+            oss << ", thread " << record.threadIndex;
+        }
+        for (const auto& count : record.counts) {
+            oss << ", " << count.first << " " << count.second;
+        }
+        oss << "\n";
+    }
+    return oss.str();
+}
+
+bool Profiler::writeChromeTrace(const std::vector<Record>& records, const std::string& filePath)
+{
+    std::ofstream ofs(filePath, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        ofs << "{\"name\":\"" << escapeJson(record.name) << "\",\"cat\":\"strecs3d\",\"ph\":\"X\""
+            << ",\"ts\":" << record.startUs
+            << ",\"dur\":" << record.wallMs * 1000.0
+            << ",\"pid\":1,\"tid\":" << record.threadIndex
+            << ",\"args\":{\"cpu_ms\":" << record.cpuMs
+            << ",\"peak_rss_delta_bytes\":" << record.peakRssDeltaBytes;
+        for (const auto& count : record.counts) {
+            ofs << ",\"" << escapeJson(count.first) << "\":" << count.second;
+        }
+        ofs << "}}" << (i + 1 < records.size() ? ",\n" : "\n");
+    }
+    ofs << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(ofs);
+}
+
+std::string Profiler::getTraceOutputPath()
+{
+    const char* path = std::getenv("STRECS3D_TRACE");
+    return path ? std::string(path) : std::string();
+}
+
+double Profiler::getProcessCpuTimeMs()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0.0;
+    }
+    auto toMs = [](const FILETIME& ft) {
+        ULARGE_INTEGER value;
+        value.LowPart = ft.dwLowDateTime;
+        value.HighPart = ft.dwHighDateTime;
+        return static_cast<double>(value.QuadPart) / 10000.0; // 100ns単位
+    };
+    return toMs(kernelTime) + toMs(userTime);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    auto toMs = [](const timeval& tv) {
+        return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+    };
+    return toMs(usage.ru_utime) + toMs(usage.ru_stime);
+#endif
+}
+
+std::uint64_t Profiler::getPeakRssBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);          // macOS はバイト単位
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;   // Linux はキロバイト単位
+#endif
+#endif
+}
@@ -0,0 +1,84 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Profiler {
+public:
+    /// @brief 計測セッション（記録の保存先と時刻の基準）
+    class Session;
+    using SessionPtr = std::shared_ptr<Session>;
+
+    /// @brief 計測区間1つ分の記録
+    struct Record {
+        std::string name;
+        int threadIndex = 0;       ///< スレッドごとの通し番号（トレースの tid）
+        int depth = 0;             ///< 同一スレッド内での入れ子の深さ
+        double startUs = 0.0;      ///< セッション開始からの開始時刻（マイクロ秒）
+        double wallMs = 0.0;       ///< 経過時間
+        double cpuMs = 0.0;        ///< プロセス全体のCPU時間（全スレッド合計）
+        std::int64_t peakRssDeltaBytes = 0; ///< 区間中に増加したピークRSS
+        std::vector<std::pair<std::string, std::int64_t>> counts; ///< セル数・三角形数・書き込みバイト数など
+    };
+
+    /// @brief 区間の開始から終了（デストラクタ）までを計測するスコープ
+    class Scope {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /// @brief 区間の件数情報を追加します（同じキーは加算されます）。
+        void addCount(const char* key, std::int64_t value);
+
+    private:
+        SessionPtr session; ///< 開始時に呼び出しスレッドに結び付けられていたセッション
+        Record record;
+        std::chrono::steady_clock::time_point wallStart;
+        double cpuStartMs;
+        std::uint64_t peakRssStart;
+    };
+
+    /// @brief 計測の有効/無効を切り替えます（既定は有効）。
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /// @brief 新しい計測セッションを開始し、呼び出しスレッドに結び付けます。
+    /// セッションはスレッドごとに独立しており、他のスレッドで実行中の計測には影響しません。
+    /// セッションが結び付いていないスレッドの区間は記録されません。
+    static void beginSession();
+
+    /// @brief 呼び出しスレッドのセッションの記録を取り出します（取り出した記録はクリアされます）。
+    static std::vector<Record> takeRecords();
+
+    /// @brief 呼び出しスレッドに結び付いたセッションを取得します（ない場合は nullptr）。
+    static SessionPtr getCurrentSession();
+
+    /// @brief 呼び出しスレッドにセッションを結び付けます（nullptr で解除）。
+    /// 並列処理のワーカースレッドに呼び出し元のセッションを引き継ぐために使用します。
+    static void setCurrentSession(SessionPtr session);
+
+    /// @brief 記録を開始順に並べた一覧表形式の文字列にします。
+    static std::string formatSummary(const std::vector<Record>& records);
+
+    /// @brief 記録を Chrome のトレースイベント形式（chrome://tracing, Perfetto）で書き出します。
+    /// @return 書き出しに成功した場合は true
+    static bool writeChromeTrace(const std::vector<Record>& records, const std::string& filePath);
+
+    /// @brief 環境変数 STRECS3D_TRACE に指定されたトレース出力先を取得します（未設定の場合は空）。
+    static std::string getTraceOutputPath();
+
+    /// @brief プロセスのCPU時間（ミリ秒）を取得します。
+    static double getProcessCpuTimeMs();
+
+    /// @brief プロセスのピークRSS（バイト）を取得します。
+    static std::uint64_t getPeakRssBytes();
+};
+
+#endif // PROFILER_H